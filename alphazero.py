@@ -55,12 +55,17 @@ class AlphaZeroPointZero:
             player = -player
 
 
-    def train(self):
-        # train the model using supervised fine-tuning (SFT)
-        states, action_probs, rewards = zip(*[(d[0], d[1], d[2]) for d in self.data])
-        states = torch.tensor(states, dtype=torch.float32)
-        action_probs = torch.tensor(action_probs, dtype=torch.float32)
-        rewards = torch.tensor(rewards, dtype=torch.float32)
+    def train(self, replay=None, window=None):
+        # train the model using supervised fine-tuning (SFT), either on the
+        # rollouts collected in self.data or on the last `window` samples of a
+        # ReplayBuffer written by the C++ selfPlay tool
+        if replay is not None:
+            states, action_probs, rewards = (torch.from_numpy(a) for a in replay.arrays(window))
+        else:
+            states, action_probs, rewards = zip(*[(d[0], d[1], d[2]) for d in self.data])
+            states = torch.tensor(states, dtype=torch.float32)
+            action_probs = torch.tensor(action_probs, dtype=torch.float32)
+            rewards = torch.tensor(rewards, dtype=torch.float32)
         
         dataset = torch.utils.data.TensorDataset(states, action_probs, rewards)
         dataloader = torch.utils.data.DataLoader(dataset, batch_size=64, shuffle=True)
@@ -2,7 +2,6 @@
 #define ALPHAZERO_H
 
 #include "mcts.h"
-#include <torch/torch.h>
 
 class AlphaZeroV1 {
 public:
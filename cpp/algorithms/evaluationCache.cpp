@@ -0,0 +1,203 @@
+#include "evaluationCache.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+const int SHARD_BITS = 4;
+
+std::size_t nextPowerOfTwo(std::size_t n) {
+    std::size_t power = 1;
+    while (power < n) {
+        power *= 2;
+    }
+    return power;
+}
+
+}
+
+EvaluationCache::EvaluationCache(std::size_t megabytes, int actionSize)
+    : numActions(actionSize), numShards(std::size_t(1) << SHARD_BITS), shardShift(64 - SHARD_BITS),
+      modelVersion(0), hasModelVersion(false), invalidations(0), epoch(0) {
+    if (actionSize <= 0) {
+        throw std::invalid_argument("Invalid action size");
+    }
+
+    // Entry and policy per cached position, plus an index kept at most half
+    // full so probe sequences stay short. Shrink until everything fits.
+    std::size_t budget = (megabytes << 20) / numShards;
+    std::size_t entryBytes = sizeof(Entry) + actionSize * sizeof(float);
+    shardCapacity = budget / (entryBytes + 2 * sizeof(int32_t));
+    while (shardCapacity > 1 &&
+           shardCapacity * entryBytes + nextPowerOfTwo(shardCapacity * 2) * sizeof(int32_t) > budget) {
+        shardCapacity -= shardCapacity / 16 + 1;
+    }
+    shardCapacity = std::max<std::size_t>(shardCapacity, 1);
+
+    shards.reset(new Shard[numShards]);
+    for (std::size_t i = 0; i < numShards; ++i) {
+        Shard& shard = shards[i];
+        shard.entries.resize(shardCapacity);
+        shard.policies.resize(shardCapacity * actionSize);
+        shard.index.assign(nextPowerOfTwo(shardCapacity * 2), -1);
+        shard.used = 0;
+        shard.hand = 0;
+        shard.epoch = 0;
+        shard.hits = shard.misses = shard.insertions = shard.evictions = 0;
+    }
+}
+
+void EvaluationCache::refresh(Shard& shard) {
+    uint64_t current = epoch.load(std::memory_order_acquire);
+    if (shard.epoch != current) {
+        std::fill(shard.index.begin(), shard.index.end(), -1);
+        shard.used = 0;
+        shard.hand = 0;
+        shard.epoch = current;
+    }
+}
+
+int32_t EvaluationCache::find(const Shard& shard, uint64_t hash) const {
+    std::size_t mask = shard.index.size() - 1;
+    for (std::size_t i = home(shard, hash);; i = (i + 1) & mask) {
+        int32_t slot = shard.index[i];
+        if (slot < 0 || shard.entries[slot].key == hash) {
+            return slot;
+        }
+    }
+}
+
+void EvaluationCache::addToIndex(Shard& shard, uint64_t hash, int32_t slot) {
+    std::size_t mask = shard.index.size() - 1;
+    std::size_t i = home(shard, hash);
+    while (shard.index[i] >= 0) {
+        i = (i + 1) & mask;
+    }
+    shard.index[i] = slot;
+}
+
+void EvaluationCache::eraseFromIndex(Shard& shard, uint64_t hash) {
+    std::size_t mask = shard.index.size() - 1;
+    std::size_t hole = home(shard, hash);
+    while (shard.entries[shard.index[hole]].key != hash) {
+        hole = (hole + 1) & mask;
+    }
+
+    // Backward-shift deletion: move later members of the probe run into the
+    // hole unless that would put them before their home slot
+    for (std::size_t next = (hole + 1) & mask; shard.index[next] >= 0; next = (next + 1) & mask) {
+        std::size_t want = home(shard, shard.entries[shard.index[next]].key);
+        bool between = hole <= next ? (hole < want && want <= next) : (hole < want || want <= next);
+        if (!between) {
+            shard.index[hole] = shard.index[next];
+            hole = next;
+        }
+    }
+    shard.index[hole] = -1;
+}
+
+bool EvaluationCache::lookup(uint64_t hash, float* policy, float& value) {
+    Shard& shard = shardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    refresh(shard);
+
+    int32_t slot = find(shard, hash);
+    if (slot < 0) {
+        shard.misses++;
+        return false;
+    }
+
+    Entry& entry = shard.entries[slot];
+    entry.referenced = true;
+    value = entry.value;
+    const float* cached = shard.policies.data() + static_cast<std::size_t>(slot) * numActions;
+    std::copy(cached, cached + numActions, policy);
+    shard.hits++;
+    return true;
+}
+
+void EvaluationCache::insert(uint64_t hash, const float* policy, float value) {
+    Shard& shard = shardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    refresh(shard);
+
+    int32_t slot = find(shard, hash);
+    if (slot < 0) {
+        if (shard.used < shardCapacity) {
+            slot = static_cast<int32_t>(shard.used++);
+        } else {
+            // CLOCK: give referenced entries a second chance
+            while (shard.entries[shard.hand].referenced) {
+                shard.entries[shard.hand].referenced = false;
+                shard.hand = (shard.hand + 1) % shardCapacity;
+            }
+            slot = static_cast<int32_t>(shard.hand);
+            shard.hand = (shard.hand + 1) % shardCapacity;
+            eraseFromIndex(shard, shard.entries[slot].key);
+            shard.evictions++;
+        }
+        shard.entries[slot].key = hash;
+        addToIndex(shard, hash, slot);
+        shard.insertions++;
+    }
+
+    Entry& entry = shard.entries[slot];
+    entry.value = value;
+    entry.referenced = false;
+    std::copy(policy, policy + numActions, shard.policies.data() + static_cast<std::size_t>(slot) * numActions);
+}
+
+void EvaluationCache::setModelVersion(uint64_t version) {
+    std::lock_guard<std::mutex> lock(versionMutex);
+    if (hasModelVersion && version == modelVersion) {
+        return;
+    }
+    if (hasModelVersion) {
+        invalidations++;
+        // Shards drop their contents the next time they are used
+        epoch.fetch_add(1, std::memory_order_acq_rel);
+    }
+    modelVersion = version;
+    hasModelVersion = true;
+}
+
+void EvaluationCache::clear() {
+    epoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
+EvaluationCacheStats EvaluationCache::stats() {
+    EvaluationCacheStats result = {};
+    for (std::size_t i = 0; i < numShards; ++i) {
+        Shard& shard = shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        refresh(shard);
+        result.hits += shard.hits;
+        result.misses += shard.misses;
+        result.insertions += shard.insertions;
+        result.evictions += shard.evictions;
+        result.entries += shard.used;
+    }
+    std::lock_guard<std::mutex> lock(versionMutex);
+    result.invalidations = invalidations;
+    return result;
+}
+
+void EvaluationCache::resetStats() {
+    for (std::size_t i = 0; i < numShards; ++i) {
+        Shard& shard = shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.hits = shard.misses = shard.insertions = shard.evictions = 0;
+    }
+    std::lock_guard<std::mutex> lock(versionMutex);
+    invalidations = 0;
+}
+
+std::size_t EvaluationCache::bytes() const {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < numShards; ++i) {
+        const Shard& shard = shards[i];
+        total += sizeof(Shard) + shard.entries.size() * sizeof(Entry) +
+                 shard.policies.size() * sizeof(float) + shard.index.size() * sizeof(int32_t);
+    }
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#ifndef EVALUATION_CACHE_H
+#define EVALUATION_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct EvaluationCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t insertions;
+    uint64_t evictions;
+    uint64_t invalidations;  // times the contents were dropped for new weights
+    std::size_t entries;
+
+    double hitRate() const {
+        uint64_t lookups = hits + misses;
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+// Network evaluations (masked policy and value) keyed by position hash that
+// outlive a single search. One cache is meant to serve every search of a
+// worker process: consecutive moves of a game revisit most of the previous
+// tree, and self-play games share their openings.
+//
+// Memory is fixed at construction. When full, entries are evicted with the
+// CLOCK algorithm, an approximation of LRU: a hit marks the entry, and the
+// hand skips marked entries once before evicting them. The cache is split
+// into shards by hash, each with its own lock, so threads of one search
+// rarely contend.
+//
+// Cached values are only valid for the weights that produced them. Searches
+// call setModelVersion() with Model::version(), and a different version
+// drops all entries.
+class EvaluationCache {
+public:
+    EvaluationCache(std::size_t megabytes, int actionSize);
+
+    EvaluationCache(const EvaluationCache&) = delete;
+    EvaluationCache& operator=(const EvaluationCache&) = delete;
+
+    // Copies the cached evaluation of hash into policy (actionSize floats)
+    // and value. Returns false if the position is not cached.
+    bool lookup(uint64_t hash, float* policy, float& value);
+    void insert(uint64_t hash, const float* policy, float value);
+
+    // Drops every entry if version differs from the one the entries were
+    // computed with
+    void setModelVersion(uint64_t version);
+    void clear();
+
+    EvaluationCacheStats stats();
+    void resetStats();
+
+    int actionSize() const { return numActions; }
+    std::size_t capacity() const { return numShards * shardCapacity; }
+    std::size_t bytes() const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        float value;
+        bool referenced;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        std::vector<float> policies;      // actionSize floats per entry
+        std::vector<int32_t> index;       // open addressing: entry of each key, or -1
+        std::size_t used;
+        std::size_t hand;
+        uint64_t epoch;                   // contents are dropped when behind the cache
+
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t insertions;
+        uint64_t evictions;
+    };
+
+    Shard& shardOf(uint64_t hash) { return shards[hash >> shardShift]; }
+    // Brings a locked shard up to the current epoch
+    void refresh(Shard& shard);
+    std::size_t home(const Shard& shard, uint64_t hash) const { return hash & (shard.index.size() - 1); }
+    int32_t find(const Shard& shard, uint64_t hash) const;
+    void addToIndex(Shard& shard, uint64_t hash, int32_t slot);
+    void eraseFromIndex(Shard& shard, uint64_t hash);
+
+    int numActions;
+    std::size_t numShards;
+    int shardShift;
+    std::size_t shardCapacity;
+    std::unique_ptr<Shard[]> shards;
+
+    std::mutex versionMutex;
+    uint64_t modelVersion;
+    bool hasModelVersion;
+    uint64_t invalidations;
+    std::atomic<uint64_t> epoch;
+};
+
+#endif // EVALUATION_CACHE_H
\ No newline at end of file
@@ -0,0 +1,158 @@
+#include "inferenceScheduler.h"
+#include <algorithm>
+#include <stdexcept>
+
+InferenceScheduler::Client::Client(InferenceScheduler& scheduler) : scheduler(scheduler) {
+    std::lock_guard<std::mutex> lock(scheduler.mutex);
+    scheduler.clients++;
+}
+
+InferenceScheduler::Client::~Client() {
+    {
+        std::lock_guard<std::mutex> lock(scheduler.mutex);
+        scheduler.clients--;
+    }
+    // The remaining clients may all be blocked already
+    scheduler.queued.notify_one();
+}
+
+void InferenceScheduler::Client::waitReady(std::vector<int>& ready) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (done.empty()) {
+        lock.unlock();
+        scheduler.setBlocked(true);
+        lock.lock();
+        completed.wait(lock, [this]() { return !done.empty(); });
+        lock.unlock();
+        scheduler.setBlocked(false);
+        lock.lock();
+    }
+    ready.insert(ready.end(), done.begin(), done.end());
+    done.clear();
+}
+
+void InferenceScheduler::setBlocked(bool blocked) {
+    bool allBlocked;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        blockedClients += blocked ? 1 : -1;
+        allBlocked = blockedClients == clients;
+    }
+    if (allBlocked) {
+        queued.notify_one();
+    }
+}
+
+InferenceScheduler::InferenceScheduler(Model* model, int stateSize, int actionSize, int maxBatch,
+                                       std::chrono::microseconds maxWait)
+    : model(model), stateSize(stateSize), actionSize(actionSize), maxBatch(maxBatch), maxWait(maxWait),
+      clients(0), blockedClients(0), stopping(false) {
+    if (maxBatch <= 0) {
+        throw std::invalid_argument("Inference batches need room for at least one request");
+    }
+    totals.maxBatch = maxBatch;
+    states.reserve(static_cast<size_t>(maxBatch) * stateSize);
+    policies.resize(static_cast<size_t>(maxBatch) * actionSize);
+    values.resize(maxBatch);
+    dispatcher = std::thread(&InferenceScheduler::dispatch, this);
+}
+
+InferenceScheduler::~InferenceScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queued.notify_one();
+    dispatcher.join();
+}
+
+void InferenceScheduler::submit(Client& client, InferenceRequest* request) {
+    request->submitted = std::chrono::steady_clock::now();
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back({&client, request});
+        size = queue.size();
+    }
+    // The dispatcher only cares about the first request (starts the wait)
+    // and a full batch (ends it)
+    if (size == 1 || size >= static_cast<size_t>(maxBatch)) {
+        queued.notify_one();
+    }
+}
+
+InferenceStats InferenceScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals;
+}
+
+void InferenceScheduler::dispatch() {
+    std::vector<Pending> batch;
+    batch.reserve(maxBatch);
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        queued.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+
+        auto deadline = queue.front().request->submitted + maxWait;
+        queued.wait_until(lock, deadline, [this]() {
+            return stopping || queue.size() >= static_cast<size_t>(maxBatch) || blockedClients == clients;
+        });
+
+        size_t count = std::min(queue.size(), static_cast<size_t>(maxBatch));
+        batch.assign(queue.begin(), queue.begin() + count);
+        queue.erase(queue.begin(), queue.begin() + count);
+
+        lock.unlock();
+        evaluate(batch);
+        lock.lock();
+    }
+}
+
+void InferenceScheduler::evaluate(std::vector<Pending>& batch) {
+    int count = static_cast<int>(batch.size());
+    auto start = std::chrono::steady_clock::now();
+    double queueSeconds = 0.0;
+    states.clear();
+    for (const Pending& pending : batch) {
+        queueSeconds += std::chrono::duration<double>(start - pending.request->submitted).count();
+        states.insert(states.end(), pending.request->state.begin(), pending.request->state.end());
+    }
+
+    model->predictBatch(states.data(), count, stateSize, policies.data(), actionSize, values.data());
+    double modelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int i = 0; i < count; ++i) {
+        InferenceRequest* request = batch[i].request;
+        const float* policy = policies.data() + static_cast<size_t>(i) * actionSize;
+        request->policy.assign(policy, policy + actionSize);
+        request->value = values[i];
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        totals.batches++;
+        totals.requests += count;
+        totals.queueSeconds += queueSeconds;
+        totals.modelSeconds += modelSeconds;
+    }
+
+    // Hand the results back, waking each client once
+    for (int i = 0; i < count; ++i) {
+        Client* client = batch[i].client;
+        if (client == nullptr) {
+            continue;
+        }
+        // Notifies under the lock: once it sees its results the client may
+        // finish and destroy itself
+        std::lock_guard<std::mutex> lock(client->mutex);
+        for (int j = i; j < count; ++j) {
+            if (batch[j].client == client) {
+                client->done.push_back(batch[j].request->tag);
+                batch[j].client = nullptr;
+            }
+        }
+        client->completed.notify_one();
+    }
+}
\ No newline at end of file
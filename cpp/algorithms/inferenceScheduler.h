@@ -0,0 +1,108 @@
+#ifndef INFERENCE_SCHEDULER_H
+#define INFERENCE_SCHEDULER_H
+
+#include "model.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One leaf evaluation requested by a search. The client fills state and
+// tag; the scheduler fills policy and value.
+struct InferenceRequest {
+    std::vector<float> state;
+    std::vector<float> policy;
+    float value = 0.0f;
+    int tag = 0;
+    std::chrono::steady_clock::time_point submitted;
+};
+
+struct InferenceStats {
+    long long batches = 0;
+    long long requests = 0;
+    int maxBatch = 0;
+    double queueSeconds = 0.0;   // summed over requests, submit to dispatch
+    double modelSeconds = 0.0;   // summed over batches
+
+    double meanBatchSize() const { return batches > 0 ? static_cast<double>(requests) / batches : 0.0; }
+    double meanBatchFill() const { return maxBatch > 0 ? meanBatchSize() / maxBatch : 0.0; }
+    double meanQueueMillis() const { return requests > 0 ? 1000.0 * queueSeconds / requests : 0.0; }
+};
+
+// Collects leaf evaluations from many searches into shared model calls. A
+// dispatcher thread runs one predictBatch() as soon as maxBatch requests
+// are queued, the oldest one has waited maxWait, or every client is blocked
+// in waitReady() so no more requests can come.
+class InferenceScheduler {
+public:
+    // Where completed requests are reported; one per thread that submits.
+    // Registered with the scheduler for its whole lifetime.
+    class Client {
+    public:
+        explicit Client(InferenceScheduler& scheduler);
+        ~Client();
+
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        // Blocks until requests of this client completed, then moves their
+        // tags to ready
+        void waitReady(std::vector<int>& ready);
+
+    private:
+        friend class InferenceScheduler;
+
+        InferenceScheduler& scheduler;
+        std::mutex mutex;
+        std::condition_variable completed;
+        std::vector<int> done;
+    };
+
+    InferenceScheduler(Model* model, int stateSize, int actionSize, int maxBatch,
+                       std::chrono::microseconds maxWait);
+    // Stops the dispatcher once the queue is empty
+    ~InferenceScheduler();
+
+    InferenceScheduler(const InferenceScheduler&) = delete;
+    InferenceScheduler& operator=(const InferenceScheduler&) = delete;
+
+    // Queues request, which must stay alive until client reports its tag
+    void submit(Client& client, InferenceRequest* request);
+
+    InferenceStats stats() const;
+
+private:
+    struct Pending {
+        Client* client;
+        InferenceRequest* request;
+    };
+
+    void setBlocked(bool blocked);
+    void dispatch();
+    void evaluate(std::vector<Pending>& batch);
+
+    Model* model;
+    int stateSize;
+    int actionSize;
+    int maxBatch;
+    std::chrono::microseconds maxWait;
+
+    mutable std::mutex mutex;
+    std::condition_variable queued;
+    std::deque<Pending> queue;
+    int clients;
+    int blockedClients;
+    bool stopping;
+    InferenceStats totals;
+
+    // Dispatcher-only buffers
+    std::vector<float> states;
+    std::vector<float> policies;
+    std::vector<float> values;
+
+    std::thread dispatcher;
+};
+
+#endif // INFERENCE_SCHEDULER_H
\ No newline at end of file
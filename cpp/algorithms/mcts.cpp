@@ -1,286 +1,72 @@
 #include "mcts.h"
-#include <iostream>
 #include <algorithm>
-#include <random>
 #include <numeric>
-#include <cassert>
+#include <stdexcept>
+#include <chrono>
+#include <limits>
 
-// Static member initialization
-int MCTSNode::nextNodeId = 0;
+namespace mctsDetail {
 
-MCTSNode::MCTSNode(
-    Game* game,
-    const GameState& state,
-    int actionTaken,
-    int player,
-    float reward,
-    MCTSNode* parent,
-    float probPrior,
-    float explorationWeight,
-    int nodeId
-) : game(game), state(state), actionTaken(actionTaken), player(player), 
-    reward(reward), parent(parent), probPrior(probPrior), 
-    explorationWeight(explorationWeight), valueSum(0.0f), visits(0),
-    nodeId(nodeId == 0 ? ++nextNodeId : nodeId) {
-}
-
-MCTSNode::~MCTSNode() {
-    // Unique pointers will automatically clean up children
-}
-
-bool MCTSNode::isFullyExpanded() const {
-    return !children.empty() || (state.isTerminal && visits > 0);
-}
-
-float MCTSNode::getUCB(const MCTSNode* child) const {
-    float qValue = 0.0f;
-    if (child->visits > 0) {
-        qValue = -child->valueSum / child->visits;
+Budget limitBudget(const SearchLimits& limits, int numTrees, int t) {
+    Budget budget = {std::numeric_limits<int>::max(), limits.deadline, 0, limits.stopWhenDecided, nullptr};
+    if (limits.simulations > 0) {
+        budget.simulations = limits.simulations / numTrees + (t < limits.simulations % numTrees ? 1 : 0);
     }
-    
-    return qValue + explorationWeight * child->probPrior * 
-           (std::sqrt(static_cast<float>(visits)) / (1.0f + child->visits));
-}
-
-MCTSNode* MCTSNode::bestChild() const {
-    if (children.empty()) {
-        return nullptr;
+    std::size_t nodes = limits.nodes;
+    if (limits.bytes > 0) {
+        std::size_t fit = std::max<std::size_t>(limits.bytes / NodeArena::nodeBytes(), 1);
+        nodes = nodes > 0 ? std::min(nodes, fit) : fit;
     }
-    
-    auto bestIt = std::max_element(children.begin(), children.end(),
-        [this](const std::unique_ptr<MCTSNode>& a, const std::unique_ptr<MCTSNode>& b) {
-            return getUCB(a.get()) < getUCB(b.get());
-        });
-    
-    return bestIt->get();
-}
-
-void MCTSNode::expand(const std::vector<float>& policy) {
-    std::vector<int> validActions = game->getValidActions(state);
-    
-    for (int action : validActions) {
-        auto [newState, r] = game->move(state, action);
-        newState = game->flipBoard(newState);
-        int newPlayer = -player;
-        float newReward = game->getOpponentReward(r);
-        
-        auto childNode = std::make_unique<MCTSNode>(
-            game, newState, action, newPlayer, newReward,
-            this, policy[action], explorationWeight, 0
-        );
-        
-        children.push_back(std::move(childNode));
+    if (nodes > 0) {
+        budget.maxNodes = std::max<std::size_t>(nodes / numTrees, 1);
     }
+    return budget;
 }
 
-void MCTSNode::backpropagate(float value) {
-    visits++;
-    valueSum += value;
-    
-    if (parent != nullptr) {
-        parent->backpropagate(game->getOpponentReward(value));
+void spend(Budget& budget, int simulations) {
+    if (budget.simulations != std::numeric_limits<int>::max()) {
+        budget.simulations -= simulations;
     }
 }
 
-void MCTSNode::print(int depth) const {
-    std::string indent(depth * 2, ' ');
-    std::string playerStr = (player == 1) ? "AI" : "H";
-    std::cout << indent << playerStr << "(id=" << nodeId 
-              << ", action_taken=" << actionTaken 
-              << ", value_sum=" << valueSum 
-              << ", visits=" << visits 
-              << ", reward=" << reward << ")" << std::endl;
-    
-    for (const auto& child : children) {
-        child->print(depth + 1);
+void checkLimits(const SearchLimits& limits) {
+    if (limits.simulations <= 0 && limits.deadline == std::chrono::steady_clock::time_point::max() &&
+        limits.nodes == 0 && limits.bytes == 0) {
+        throw std::invalid_argument("Search limits need a simulation, time or tree size limit");
     }
 }
 
-MCTS::MCTS(Game* game, Model* model, int numSimulations, float explorationWeight)
-    : game(game), model(model), numSimulations(numSimulations), 
-      explorationWeight(explorationWeight) {
+void finishStats(SearchStats& stats, std::chrono::steady_clock::time_point start) {
+    stats.searches = 1;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
 }
 
-std::vector<float> MCTS::search(const GameState& state) {
-    auto root = std::make_unique<MCTSNode>(game, state, -1, 1, 0.0f, nullptr, 1.0f, explorationWeight);
-    
-    for (int i = 0; i < numSimulations; ++i) {
-        MCTSNode* parent = root.get();
-        
-        // Selection phase
-        while (parent->isFullyExpanded()) {
-            if (parent->state.isTerminal) {
-                break;
-            }
-            parent = parent->bestChild();
-        }
-        
-        float value;
-        
-        if (!parent->state.isTerminal) {
-            // Expansion and evaluation phase
-            std::vector<float> encodedState = game->encodeState(parent->state);
-            auto [policy, predictedValue] = model->predict(encodedState);
-            
-            // Apply validity mask to policy
-            std::vector<int> validActions = game->getValidActions(parent->state);
-            std::vector<float> validity(game->actionSpaceSize(), 0.0f);
-            for (int action : validActions) {
-                validity[action] = 1.0f;
-            }
-            
-            // Element-wise multiplication and normalization
-            float policySum = 0.0f;
-            for (size_t j = 0; j < policy.size(); ++j) {
-                policy[j] *= validity[j];
-                policySum += policy[j];
-            }
-            
-            if (policySum > 0.0f) {
-                for (float& p : policy) {
-                    p /= policySum;
-                }
-            }
-            
-            parent->expand(policy);
-            value = predictedValue;
-        } else {
-            value = parent->reward;
-        }
-        
-        // Backpropagation phase
-        parent->backpropagate(value);
-    }
-    
-    // Calculate action probabilities based on visit counts
-    std::vector<float> probs(game->actionSpaceSize(), 0.0f);
-    float totalVisits = 0.0f;
-    
-    for (const auto& child : root->children) {
-        probs[child->actionTaken] = static_cast<float>(child->visits);
-        totalVisits += child->visits;
-    }
-
-    // Normalize probabilities
+std::vector<float> normalizeVisits(std::vector<float> probs) {
+    float totalVisits = std::accumulate(probs.begin(), probs.end(), 0.0f);
     if (totalVisits > 0.0f) {
         for (float& prob : probs) {
             prob /= totalVisits;
         }
     }
-    
     return probs;
 }
 
-
-MCTS2::MCTS2(Game* game, Model* model, int numSimulations, float explorationWeight)
-    : game(game), model(model), numSimulations(numSimulations), 
-      explorationWeight(explorationWeight) {
-    root = nullptr;
 }
 
-std::vector<float> MCTS2::search(const GameState& state) {
-    // check if any of the child states are equal to state 2 levels down
-    bool createNew = true;
-    if (root) {
-        for (auto& child : root->children) {
-            if (game->checkEq(child->state, state)) {
-                // If we found a matching child, we can use it
-                root = std::move(child);
-                root->parent = nullptr;
-                createNew = false;
-                break;
-            }
-        }
-    }
-
-    if(createNew)
-        root = std::make_unique<MCTSNode>(game, state, -1, 1, 0.0f, nullptr, 1.0f, explorationWeight);
-    
-    for (int i = 0; i < numSimulations; ++i) {
-        MCTSNode* parent = root.get();
-        
-        // Selection phase
-        while (parent->isFullyExpanded()) {
-            if (parent->state.isTerminal) {
-                break;
-            }
-            parent = parent->bestChild();
-        }
-        
-        float value;
-        
-        if (!parent->state.isTerminal) {
-            // Expansion and evaluation phase
-            std::vector<float> encodedState = game->encodeState(parent->state);
-            auto [policy, predictedValue] = model->predict(encodedState);
-            
-            // Apply validity mask to policy
-            std::vector<int> validActions = game->getValidActions(parent->state);
-            std::vector<float> validity(game->actionSpaceSize(), 0.0f);
-            for (int action : validActions) {
-                validity[action] = 1.0f;
-            }
-            
-            // Element-wise multiplication and normalization
-            float policySum = 0.0f;
-            for (size_t j = 0; j < policy.size(); ++j) {
-                policy[j] *= validity[j];
-                policySum += policy[j];
-            }
-            
-            if (policySum > 0.0f) {
-                for (float& p : policy) {
-                    p /= policySum;
-                }
-            }
-            
-            parent->expand(policy);
-            value = predictedValue;
-        } else {
-            value = parent->reward;
-        }
-        
-        // Backpropagation phase
-        parent->backpropagate(value);
-    }
-    
-    // Calculate action probabilities based on visit counts
-    std::vector<float> probs(game->actionSpaceSize(), 0.0f);
-    float totalVisits = 0.0f;
-    
-    for (const auto& child : root->children) {
-        probs[child->actionTaken] = static_cast<float>(child->visits);
-        totalVisits += child->visits;
-    }
-
-    // Normalize probabilities
-    if (totalVisits > 0.0f) {
-        for (float& prob : probs) {
-            prob /= totalVisits;
-        }
-    }
-
-    // !ASSUMPTION
-    // assume that game continues and we pick highest prob state
-    int bestAction = 0;
-    float bestProb = probs[0];
-    for (size_t i = 1; i < probs.size(); ++i) {
-        if (probs[i] > bestProb) {
-            bestProb = probs[i];
-            bestAction = static_cast<int>(i);
-        }
-    }
-    for(auto &child : root->children) {
-        if (child->actionTaken == bestAction) {
-            root = std::move(child);
-            root->parent = nullptr;
-            break;
-        }
-    }
-
-    return probs;
+SearchLimits SearchLimits::time(double seconds) {
+    SearchLimits limits;
+    limits.deadline = std::chrono::steady_clock::now() +
+                      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                          std::chrono::duration<double>(seconds));
+    return limits;
 }
 
+// The search over Game<int>, compiled once here for every user of MCTSTree,
+// MCTS and MCTS2
+template class BasicMCTSTree<Game<int>>;
+template class BasicMCTS<Game<int>>;
+template class BasicMCTS2<Game<int>>;
+
 
 // RandomModel implementation
 RandomModel::RandomModel(int stateSize, int actionSize)
@@ -291,3 +77,9 @@ std::pair<std::vector<float>, float> RandomModel::predict(const std::vector<floa
     std::vector<float> policy(actionSize, 1.0f / actionSize);
     return std::make_pair(policy, 0.0f);
 }
+
+void RandomModel::predictBatch(const float* /* states */, int batchSize, int /* stateSize */,
+                               float* policies, int /* actionSize */, float* values) {
+    std::fill(policies, policies + static_cast<size_t>(batchSize) * actionSize, 1.0f / actionSize);
+    std::fill(values, values + batchSize, 0.0f);
+}
@@ -2,87 +2,351 @@
 #define MCTS_H
 
 #include "../games/GameEnv.h"
+#include "model.h"
+#include "nodeArena.h"
+#include "transpositionTable.h"
+#include "evaluationCache.h"
+#include "searchStats.h"
+#include "treeFile.h"
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <random>
+#include <atomic>
+#include <thread>
 
-// Forward declaration for neural network model interface
-class Model {
-public:
-    virtual ~Model() = default;
-    virtual std::pair<std::vector<float>, float> predict(const std::vector<float>& encodedState) = 0;
-};
+// The search is written once as templates over the game type G.
+// BasicMCTS<ConnectFour> calls the game's final, inline move(), flipBoard()
+// and validActions() directly and keeps valid-action masks on the stack in
+// std::arrays sized by GameTraits<G>. MCTSTree, MCTS and MCTS2 are the same
+// templates over Game<int>, for games only known at run time; they go
+// through the virtual interface and are compiled once, in mcts.cpp.
 
-class MCTSNode {
+// A search tree stored in a NodeArena. Siblings are contiguous, so a node's
+// children are visited as a plain index range and their statistics can be
+// scored in one vectorized pass.
+template<typename G>
+class BasicMCTSTree {
 public:
-    MCTSNode(
-        Game* game,
-        const GameState& state,
-        int actionTaken = -1,
-        int player = 1,
-        float reward = 0.0f,
-        MCTSNode* parent = nullptr,
-        float probPrior = 1.0f,
-        float explorationWeight = 1.0f,
-        int nodeId = 0
-    );
-
-    ~MCTSNode();
-
-    bool isFullyExpanded() const;
-    float getUCB(const MCTSNode* child) const;
-    MCTSNode* bestChild() const;
-    void expand(const std::vector<float>& policy);
-    void backpropagate(float value);
-    void print(int depth = 0) const;
-
-    // Public members for easier access (similar to Python version)
-    // Order matches constructor initialization list
-    Game* game;
-    GameState state;
-    int actionTaken;
-    int player;
-    float reward;
-    MCTSNode* parent;
-    float probPrior;
-    float explorationWeight;
-    float valueSum;
-    int visits;
-    int nodeId;
-    
-    std::vector<std::unique_ptr<MCTSNode>> children;
+    BasicMCTSTree(G* game, float explorationWeight = 1.0f);
+
+    // Drops the current tree in O(1) and starts a new one at state
+    void reset(const GameState& state);
+    bool empty() const;
+
+    NodeIndex root() const { return rootIdx; }
+    MCTSNode& node(NodeIndex index) { return arena[index]; }
+    const MCTSNode& node(NodeIndex index) const { return arena[index]; }
+    int action(NodeIndex index) const { return arena.action(index); }
+    int visits(NodeIndex index) const { return arena.visits(index); }
+    float valueSum(NodeIndex index) const { return arena.valueSum(index); }
+    float prior(NodeIndex index) const { return arena.prior(index); }
+    void setPrior(NodeIndex index, float prior) { arena.prior(index) = prior; }
+    const NodeArena& nodes() const { return arena; }
+
+    // Lazy expansion: expand() records only the action, prior and statistics
+    // of each child, and selectChild() builds a child's state and node the
+    // first time it picks that child. The search is the same, but children
+    // never selected cost neither move() and flipBoard() nor an MCTSNode.
+    // node() is only valid for built nodes; with lazy expansion off, as by
+    // default, every node is built.
+    void setLazyExpansion(bool enabled) { lazy = enabled; }
+    bool lazyExpansion() const { return lazy; }
+    bool built(NodeIndex index) const { return arena.hasNode(index); }
+    // Builds child, a child of parent, if it has not been built yet
+    void buildChild(NodeIndex parent, NodeIndex child);
+
+    // Makes a built node of the current tree the new root. Only the index
+    // changes; the rest of the old tree stays in the arena until compact()
+    // or reset().
+    void setRoot(NodeIndex index);
+
+    // Copies the subtree under the root into the spare arena and swaps arenas,
+    // releasing everything outside that subtree. Cost is linear in the size
+    // of the kept subtree only, and nothing if the root has not moved since
+    // the last reset(), compact() or load().
+    void compact();
+
+    // Collapses the least visited subtrees below the root back into leaves
+    // until at most maxNodes nodes are live, and returns how many it
+    // collapsed. A collapsed node keeps its visits and value and is
+    // expanded again when a search next reaches it; the nodes below it go
+    // back to the arena for reuse. Not safe while a search runs.
+    int collapse(std::size_t maxNodes);
+
+    // Writes the subtree under from (the root if NO_NODE) to path, with
+    // every node's action, prior and statistics (see treeFile.h)
+    void save(const std::string& path, NodeIndex from = NO_NODE) const;
+    // Replaces the tree with one written by save(). Nodes that were built
+    // are built again, and with lazy expansion off every other node too.
+    // Throws if the file does not hold a tree of this game, leaving the
+    // tree empty.
+    void load(const std::string& path);
+
+    bool isFullyExpanded(NodeIndex index) const;
+    float getUCB(NodeIndex parent, NodeIndex child) const;
+    NodeIndex bestChild(NodeIndex index) const;
+    // bestChild(), built if needed
+    NodeIndex selectChild(NodeIndex index);
+
+    // Claims the right to expand a leaf. Exactly one caller succeeds; the
+    // others can waitForExpansion() and continue below it.
+    bool tryBeginExpand(NodeIndex index);
+    void waitForExpansion(NodeIndex index) const;
+    void expand(NodeIndex index, const float* policy);
+
+    void addVirtualLoss(NodeIndex index, int virtualLoss);
+    // Path forms take the nodes of one selection, root first and the leaf
+    // last, and touch only their statistics. getOpponentReward() must be
+    // its own inverse.
+    // Takes virtualLoss back off every node of path
+    void removeVirtualLoss(const NodeIndex* path, int length, int virtualLoss);
+    // Backs value up path, removing virtualLoss added on the way down
+    void backpropagate(const NodeIndex* path, int length, float value, int virtualLoss = 0);
+    // Backs value up from index to the root by parent links
+    void backpropagate(NodeIndex index, float value, int virtualLoss = 0);
+    void print(NodeIndex index, int depth = 0) const;
+
+    // Live nodes, built or not, and the memory they take
+    std::size_t size() const;
+    std::size_t liveBytes() const;
+    // Memory held by the arenas, in use or not
+    std::size_t bytes() const;
 
 private:
-    static int nextNodeId;
+    void copyStats(NodeIndex from, NodeIndex to);
+    // Releases everything below index and makes it a leaf again
+    void releaseChildren(NodeIndex index);
+    void restore(const std::string& path, const std::vector<TreeFileRecord>& records);
+    void buildNode(MCTSNode& child, const MCTSNode& parent, NodeIndex parentIdx, int action);
+
+    G* game;
+    float explorationWeight;
+    bool lazy;
+    bool rootMoved;   // nodes outside the root's subtree may be in the arena
+    NodeArena arena;
+    NodeArena spare;
+    NodeIndex rootIdx;
 };
 
-class MCTS {
+// When a search stops. Every limit is optional (zero or unset) but at least
+// one of simulations, deadline and a tree size must be given. Whichever is
+// reached first ends the search, which then returns the visit distribution
+// it has so far; at least one simulation always runs.
+struct SearchLimits {
+    int simulations = 0;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    // Caps on the tree, including nodes kept from the previous search. The
+    // search stops before a batch whose expansions could exceed them; with
+    // several threads the batches in flight may still overshoot a little.
+    // bytes counts every node at NodeArena::nodeBytes(), built or not.
+    std::size_t nodes = 0;
+    std::size_t bytes = 0;
+    // Stops once the most visited root child is ahead by more visits than
+    // the simulations left, so no remaining simulation can change the move.
+    // With a deadline the simulations left are estimated from the rate so
+    // far. Shifts the visit distribution; meant for play, not for
+    // generating training targets.
+    bool stopWhenDecided = false;
+
+    // Limits that stop after seconds of wall-clock time from now
+    static SearchLimits time(double seconds);
+};
+
+// Dirichlet noise mixed into the priors of the root's children at the start
+// of every search, as in AlphaZero self-play:
+//
+//     P(a) = (1 - fraction) * P(a) + fraction * Dir(alpha)
+struct RootNoise {
+    float alpha;
+    float fraction;   // 0 disables the noise
+    std::mt19937_64 rng;
+};
+
+template<typename G>
+class BasicMCTS {
 public:
-    MCTS(Game* game, Model* model, int numSimulations = 1000, float explorationWeight = 1.0f);
-    ~MCTS() = default;
+    BasicMCTS(G* game, Model* model, int numSimulations = 1000, float explorationWeight = 1.0f,
+              int numThreads = 1, int batchSize = 1);
+    ~BasicMCTS() = default;
+
+    // Returns the visit distribution over actions. If stats is given it
+    // receives what this search did.
+    std::vector<float> search(const GameState& state, SearchStats* stats = nullptr);
+    // Searches until the first of limits is reached instead of for
+    // numSimulations simulations
+    std::vector<float> search(const GameState& state, const SearchLimits& limits, SearchStats* stats = nullptr);
+
+    // Caches evaluations by position hash within each search, using at most
+    // bytes of memory. Positions reached by several move orders then cost
+    // one model call.
+    void enableTranspositionTable(std::size_t bytes);
+    const TranspositionTable* transpositionTable() const { return transpositions.get(); }
 
-    std::vector<float> search(const GameState& state);
+    // Looks up and stores evaluations in a cache that outlives this search,
+    // usually shared by every search of a worker. Not owned; null disables.
+    void setEvaluationCache(EvaluationCache* cache);
+
+    // Enables root noise (fraction > 0) and reseeds its generator. An
+    // unexpanded root is evaluated first, which counts as one simulation.
+    void setRootNoise(float alpha, float fraction, uint64_t seed);
+
+    // Builds the children of a node only when the search first selects
+    // them (see BasicMCTSTree::setLazyExpansion). On by default; results
+    // are the same either way.
+    void setLazyExpansion(bool enabled);
+
+    // Root parallelism: with numTrees > 1, search() grows numTrees
+    // independent trees from the root, each on its own thread with its own
+    // arena, and returns their merged root visit counts. The trees share
+    // no nodes, so nothing is locked while they search; numSimulations is
+    // split between them and numThreads is not used. Each tree mixes its
+    // own root noise from a generator seeded with seed and its index (the
+    // configured root noise, or a mild default without it) so the trees
+    // explore differently. numTrees <= 1 returns to a single tree.
+    void setRootParallel(int numTrees, uint64_t seed = 0);
+
+    // Stepwise search for callers that evaluate leaves themselves, e.g. to
+    // put the leaves of many searches into one model call. After
+    // beginSearch(), nextLeaf() runs simulations until one needs the model
+    // and returns that leaf's state, or null once numSimulations are done.
+    // Every returned leaf needs evaluate() with the model's raw policy and
+    // value before the next nextLeaf(). Runs on the calling thread only;
+    // the results equal those of search() with one thread and batchSize 1.
+    // The stats time evaluation as the wait between nextLeaf() and
+    // evaluate(), and seconds as the wall time of the whole search.
+    void beginSearch(const GameState& state);
+    const GameState* nextLeaf();
+    void evaluate(const float* policy, float value);
+    std::vector<float> searchResult(SearchStats* stats = nullptr) const;
 
 private:
-    Game* game;
+    using Tree = BasicMCTSTree<G>;
+
+    struct RootTree {
+        std::unique_ptr<Tree> tree;
+        RootNoise noise;
+    };
+
+    void prepareSearch();
+    std::vector<float> searchRootParallel(const GameState& state, const SearchLimits& limits, SearchStats& stats);
+
+    G* game;
     Model* model;
     int numSimulations;
     float explorationWeight;
+    int numThreads;
+    int batchSize;   // leaves gathered per model call
+    Tree tree;
+    std::unique_ptr<TranspositionTable> transpositions;
+    EvaluationCache* evaluationCache;
+    RootNoise rootNoise;
+
+    // Stepwise search progress
+    int completedSimulations;
+    bool noisePending;
+    std::vector<NodeIndex> pendingPath;   // empty unless a leaf awaits evaluate()
+    std::vector<float> evaluated;
+    SearchStats currentStats;
+    std::chrono::steady_clock::time_point searchStart;
+    std::chrono::steady_clock::time_point leafReturned;
+
+    std::vector<RootTree> rootTrees;   // empty unless root-parallel
 };
 
-class MCTS2 {
+template<typename G>
+class BasicMCTS2 {
 public:
-    MCTS2(Game* game, Model* model, int numSimulations = 1000, float explorationWeight = 1.0f);
-    ~MCTS2() = default;
+    BasicMCTS2(G* game, Model* model, int numSimulations = 1000, float explorationWeight = 1.0f,
+               int numThreads = 1, int batchSize = 1);
+    ~BasicMCTS2();
+
+    // Pondering needs 256 MB of tree at most unless told otherwise
+    static constexpr std::size_t DEFAULT_PONDER_BYTES = std::size_t(256) << 20;
+
+    // Returns the visit distribution over actions. If stats is given it
+    // receives what this search did, including whether it continued the
+    // previous search's tree.
+    std::vector<float> search(const GameState& state, SearchStats* stats = nullptr);
+    // Searches until the first of limits is reached instead of for
+    // numSimulations simulations
+    std::vector<float> search(const GameState& state, const SearchLimits& limits, SearchStats* stats = nullptr);
+
+    // Caches evaluations by position hash within each search, using at most
+    // bytes of memory. Positions reached by several move orders then cost
+    // one model call.
+    void enableTranspositionTable(std::size_t bytes);
+    const TranspositionTable* transpositionTable() const { return transpositions.get(); }
 
-    std::vector<float> search(const GameState& state);
+    // Looks up and stores evaluations in a cache that outlives this search,
+    // usually shared by every search of a worker. Not owned; null disables.
+    void setEvaluationCache(EvaluationCache* cache);
+
+    // Enables root noise (fraction > 0) and reseeds its generator. An
+    // unexpanded root is evaluated first, which counts as one simulation.
+    void setRootNoise(float alpha, float fraction, uint64_t seed);
+
+    // Builds the children of a node only when the search first selects
+    // them (see BasicMCTSTree::setLazyExpansion). On by default; results
+    // are the same either way.
+    void setLazyExpansion(bool enabled);
+
+    // Pondering: after every search() a background thread goes on searching
+    // under the move that search() expects to be played, i.e. through the
+    // opponent's replies, until the next search() or stopPondering(). If
+    // the opponent's actual reply was pondered, the next search() keeps its
+    // subtree and builds on the visits gathered meanwhile. The thread uses
+    // numThreads and batchSize like a search, grows the tree to at most
+    // maxBytes and checks for a stop before every batch, so stopping takes
+    // at most one batch of simulations. Configuration calls stop it too.
+    void setPondering(bool enabled, std::size_t maxBytes = DEFAULT_PONDER_BYTES);
+    void stopPondering();
+    bool pondering() const { return ponderThread.joinable(); }
+
+    // Caps the tree kept across moves at bytes, counted like
+    // SearchLimits::bytes; 0, the default, for no cap. A search that
+    // reaches the cap collapses its least visited subtrees into leaves
+    // (see BasicMCTSTree::collapse) and carries on with the nodes they
+    // release. Pondering stops at the cap instead.
+    void setMemoryLimit(std::size_t bytes);
+
+    // Gauges of the current tree: live nodes and the memory they take. Safe
+    // to read while pondering.
+    std::size_t liveNodes() const { return tree.size(); }
+    std::size_t liveBytes() const { return tree.liveBytes(); }
+
+    // Warm starts. saveTree() writes the tree of the last search, rooted at
+    // the position it searched, and loadTree() makes a saved tree the
+    // current one, so that a search() of its root position, or of a
+    // position one move below it, continues it like the tree of a previous
+    // search. Both stop pondering.
+    void saveTree(const std::string& path);
+    void loadTree(const std::string& path);
 
 private:
-    Game* game;
+    void startPondering();
+    // The memory limit in nodes, 0 for none
+    std::size_t memoryNodes() const;
+
+    G* game;
     Model* model;
-    std::unique_ptr<MCTSNode> root;
     int numSimulations;
     float explorationWeight;
+    int numThreads;
+    int batchSize;   // leaves gathered per model call
+    BasicMCTSTree<G> tree;
+    std::unique_ptr<TranspositionTable> transpositions;
+    EvaluationCache* evaluationCache;
+    RootNoise rootNoise;
+    std::size_t memoryLimit;   // bytes, 0 for none
+
+    bool ponderEnabled;
+    std::size_t ponderBytes;
+    std::thread ponderThread;
+    std::atomic<bool> ponderStop;
+    long long ponderedSimulations;   // by the last pondering, read after joining
+    NodeIndex searchedRoot;   // root of the last search, NO_NODE if gone
 };
 
 // Simple random model implementation for testing
@@ -90,10 +354,22 @@ class RandomModel : public Model {
 public:
     RandomModel(int stateSize, int actionSize);
     std::pair<std::vector<float>, float> predict(const std::vector<float>& encodedState) override;
+    void predictBatch(const float* states, int batchSize, int stateSize,
+                      float* policies, int actionSize, float* values) override;
 
 private:
     int stateSize;
     int actionSize;
 };
 
-#endif // MCTS_H
+#include "mctsImpl.h"
+
+using MCTSTree = BasicMCTSTree<Game<int>>;
+using MCTS = BasicMCTS<Game<int>>;
+using MCTS2 = BasicMCTS2<Game<int>>;
+
+extern template class BasicMCTSTree<Game<int>>;
+extern template class BasicMCTS<Game<int>>;
+extern template class BasicMCTS2<Game<int>>;
+
+#endif // MCTS_H
\ No newline at end of file
@@ -0,0 +1,1490 @@
+#ifndef MCTS_IMPL_H
+#define MCTS_IMPL_H
+
+// Definitions of the search templates declared in mcts.h, which includes
+// this file at its end. Include mcts.h instead.
+
+#include "puct.h"
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+#include <deque>
+#include <utility>
+#include <stdexcept>
+#include <limits>
+#include <type_traits>
+
+// Helpers of the search templates
+namespace mctsDetail {
+
+// Buffer of N values on the stack when the game's action space size N is
+// known at compile time, a vector of size values otherwise
+template<typename T, int N>
+using ActionBuffer = std::conditional_t<(N > 0), std::array<T, N>, std::vector<T>>;
+
+template<typename T, int N>
+ActionBuffer<T, N> makeBuffer(int size) {
+    if constexpr (N > 0) {
+        return ActionBuffer<T, N>{};
+    } else {
+        return ActionBuffer<T, N>(size);
+    }
+}
+
+// Visits added to every node on a selected path until its value is backed up
+const int VIRTUAL_LOSS = 1;
+
+enum class LeafKind {
+    NEW,        // unexpanded leaf, now claimed by the caller
+    TERMINAL,   // game over, value is known
+    COLLISION   // leaf already claimed; virtual loss has been undone
+};
+
+// Selection phase. Walks from the root to a leaf, adding virtualLoss to every
+// node on the way and recording them in path, root first, so the leaf is
+// path.back(). A leaf that another simulation is still expanding is either
+// waited for (waitOnCollision) or reported as a collision.
+template<typename G>
+LeafKind selectLeaf(BasicMCTSTree<G>& tree, int virtualLoss, bool waitOnCollision, std::vector<NodeIndex>& path,
+                    SearchStats& stats) {
+    PhaseTimer timer(stats.selectionSeconds);
+    NodeIndex parent = tree.root();
+    path.clear();
+    path.push_back(parent);
+    if (virtualLoss) tree.addVirtualLoss(parent, virtualLoss);
+
+    while (!tree.node(parent).state.isTerminal) {
+        if (tree.isFullyExpanded(parent)) {
+            parent = tree.selectChild(parent);
+            path.push_back(parent);
+            if (virtualLoss) tree.addVirtualLoss(parent, virtualLoss);
+        } else if (tree.tryBeginExpand(parent)) {
+            if (SEARCH_PROFILING) stats.maxDepth = std::max(stats.maxDepth, static_cast<int>(path.size()) - 1);
+            return LeafKind::NEW;
+        } else if (waitOnCollision) {
+            // Another thread is expanding this leaf
+            tree.waitForExpansion(parent);
+        } else {
+            if (SEARCH_PROFILING) stats.collisions++;
+            if (virtualLoss) tree.removeVirtualLoss(path.data(), static_cast<int>(path.size()), virtualLoss);
+            return LeafKind::COLLISION;
+        }
+    }
+
+    if (SEARCH_PROFILING) stats.maxDepth = std::max(stats.maxDepth, static_cast<int>(path.size()) - 1);
+    return LeafKind::TERMINAL;
+}
+
+// Apply validity mask to policy
+template<typename G>
+void maskPolicy(G* game, const GameState& state, float* policy) {
+    using Traits = GameTraits<G>;
+    int actionSize = Traits::actionSize(*game);
+    ActionBuffer<float, Traits::ACTION_SIZE> validity = makeBuffer<float, Traits::ACTION_SIZE>(actionSize);
+    for (int action : Traits::validActions(*game, state)) {
+        validity[action] = 1.0f;
+    }
+
+    // Element-wise multiplication and normalization
+    float policySum = 0.0f;
+    for (int j = 0; j < actionSize; ++j) {
+        policy[j] *= validity[j];
+        policySum += policy[j];
+    }
+
+    if (policySum > 0.0f) {
+        for (int j = 0; j < actionSize; ++j) {
+            policy[j] /= policySum;
+        }
+    }
+}
+
+// Evaluations consulted before the model: the per-search transposition
+// table, then the cache shared across searches. Either may be null.
+struct EvaluationCaches {
+    TranspositionTable* table;
+    EvaluationCache* cache;
+
+    bool enabled() const { return table || cache; }
+
+    bool lookup(uint64_t hash, float* policy, float& value) const {
+        return (table && table->lookup(hash, policy, value)) ||
+               (cache && cache->lookup(hash, policy, value));
+    }
+
+    void store(uint64_t hash, const float* policy, float value) const {
+        if (table) table->store(hash, policy, value);
+        if (cache) cache->insert(hash, policy, value);
+    }
+};
+
+// Expands the leaf at the end of path from a fresh model evaluation and
+// backs its value up the path. policy is masked in place.
+template<typename G>
+void expandEvaluated(BasicMCTSTree<G>& tree, G* game, const EvaluationCaches& caches, const NodeIndex* path,
+                     int length, float* policy, float value, int virtualLoss, SearchStats& stats) {
+    NodeIndex leaf = path[length - 1];
+    {
+        PhaseTimer timer(stats.expansionSeconds);
+        maskPolicy(game, tree.node(leaf).state, policy);
+        caches.store(tree.node(leaf).state.hash, policy, value);
+        tree.expand(leaf, policy);
+    }
+
+    // Backpropagation phase
+    PhaseTimer timer(stats.backpropagationSeconds);
+    tree.backpropagate(path, length, value, virtualLoss);
+}
+
+// Leaves waiting for one model call, with their encoded states and selected
+// paths packed back to back. Buffers are reused from batch to batch, so a
+// worker stops allocating once they have grown to the tree's depth.
+struct LeafBatch {
+    std::vector<NodeIndex> path;      // selection scratch
+    std::vector<NodeIndex> paths;     // paths of the leaves below
+    std::vector<int> pathEnds;        // end of each leaf's path in paths
+    std::vector<float> states;
+    std::vector<float> policies;
+    std::vector<float> values;
+    std::vector<float> cached;   // policy read from a cache
+};
+
+// Gathers up to maxLeaves leaves, evaluates the new ones with one model call
+// and backs everything up. Leaves whose position is already cached are
+// expanded from the cached evaluation without waiting for the batch.
+// Gathering stops early at the first collision. Returns the number of
+// simulations completed.
+template<typename G>
+int runBatch(BasicMCTSTree<G>& tree, G* game, Model* model, const EvaluationCaches& caches,
+             int maxLeaves, int virtualLoss, bool waitOnCollision, LeafBatch& batch, SearchStats& stats) {
+    batch.paths.clear();
+    batch.pathEnds.clear();
+    batch.states.clear();
+    int completed = 0;
+    int actionSize = GameTraits<G>::actionSize(*game);
+    int stateSize = GameTraits<G>::stateSize(*game);
+
+    for (int i = 0; i < maxLeaves; ++i) {
+        LeafKind kind = selectLeaf(tree, virtualLoss, waitOnCollision, batch.path, stats);
+        if (kind == LeafKind::COLLISION) {
+            break;
+        }
+        NodeIndex leaf = batch.path.back();
+        int length = static_cast<int>(batch.path.size());
+        if (kind == LeafKind::TERMINAL) {
+            if (SEARCH_PROFILING) stats.terminalLeaves++;
+            PhaseTimer timer(stats.backpropagationSeconds);
+            tree.backpropagate(batch.path.data(), length, tree.node(leaf).reward, virtualLoss);
+            completed++;
+            continue;
+        }
+
+        if (caches.enabled()) {
+            batch.cached.resize(actionSize);
+            float value;
+            bool hit;
+            {
+                PhaseTimer timer(stats.evaluationSeconds);
+                hit = caches.lookup(tree.node(leaf).state.hash, batch.cached.data(), value);
+            }
+            if (hit) {
+                if (SEARCH_PROFILING) stats.cacheHits++;
+                {
+                    PhaseTimer timer(stats.expansionSeconds);
+                    tree.expand(leaf, batch.cached.data());
+                }
+                PhaseTimer timer(stats.backpropagationSeconds);
+                tree.backpropagate(batch.path.data(), length, value, virtualLoss);
+                completed++;
+                continue;
+            }
+        }
+
+        PhaseTimer timer(stats.evaluationSeconds);
+        batch.paths.insert(batch.paths.end(), batch.path.begin(), batch.path.end());
+        batch.pathEnds.push_back(static_cast<int>(batch.paths.size()));
+        batch.states.resize(batch.states.size() + stateSize);
+        GameTraits<G>::encode(*game, tree.node(leaf).state, batch.states.data() + batch.states.size() - stateSize);
+    }
+
+    int numLeaves = static_cast<int>(batch.pathEnds.size());
+    if (numLeaves == 0) {
+        return completed;
+    }
+
+    // Expansion and evaluation phase
+    batch.policies.resize(static_cast<size_t>(numLeaves) * actionSize);
+    batch.values.resize(numLeaves);
+
+    {
+        PhaseTimer timer(stats.evaluationSeconds);
+        if (numLeaves == 1) {
+            auto [policy, value] = model->predict(batch.states);
+            std::copy(policy.begin(), policy.end(), batch.policies.begin());
+            batch.values[0] = value;
+        } else {
+            model->predictBatch(batch.states.data(), numLeaves, stateSize,
+                                batch.policies.data(), actionSize, batch.values.data());
+        }
+    }
+    if (SEARCH_PROFILING) {
+        stats.modelCalls++;
+        stats.modelEvaluations += numLeaves;
+    }
+
+    for (int i = 0, begin = 0; i < numLeaves; begin = batch.pathEnds[i++]) {
+        float* policy = batch.policies.data() + static_cast<size_t>(i) * actionSize;
+        expandEvaluated(tree, game, caches, batch.paths.data() + begin, batch.pathEnds[i] - begin,
+                        policy, batch.values[i], virtualLoss, stats);
+        completed++;
+    }
+
+    return completed;
+}
+
+template<typename G>
+bool wantsRootNoise(const BasicMCTSTree<G>& tree, const RootNoise& noise) {
+    return noise.fraction > 0.0f && !tree.node(tree.root()).state.isTerminal;
+}
+
+// Mixes root noise into the priors of the expanded root's children
+template<typename G>
+void mixRootNoise(BasicMCTSTree<G>& tree, RootNoise& noise) {
+    const MCTSNode& root = tree.node(tree.root());
+    std::gamma_distribution<float> gamma(noise.alpha, 1.0f);
+    std::vector<float> sample(root.numChildren);
+    float total = 0.0f;
+    for (float& x : sample) {
+        x = gamma(noise.rng);
+        total += x;
+    }
+    if (total <= 0.0f) {
+        return;
+    }
+
+    for (int i = 0; i < root.numChildren; ++i) {
+        NodeIndex child = root.firstChild + i;
+        float prior = tree.prior(child);
+        tree.setPrior(child, (1.0f - noise.fraction) * prior + noise.fraction * sample[i] / total);
+    }
+}
+
+// Mixes root noise into the root priors, expanding the root first if
+// needed. Returns the number of simulations that took.
+template<typename G>
+int applyRootNoise(BasicMCTSTree<G>& tree, G* game, Model* model, const EvaluationCaches& caches,
+                   RootNoise& noise, SearchStats& stats) {
+    if (!wantsRootNoise(tree, noise)) {
+        return 0;
+    }
+
+    int used = 0;
+    if (tree.nodes().expansion(tree.root()) != EXPANDED) {
+        LeafBatch batch;
+        used = runBatch(tree, game, model, caches, 1, 0, true, batch, stats);
+    }
+    mixRootNoise(tree, noise);
+    return used;
+}
+
+// What stops runSimulations(): a number of simulations (INT_MAX for none),
+// optionally the limits of a SearchLimits, and a flag another thread can
+// raise to end the search before the next batch
+struct Budget {
+    int simulations;
+    std::chrono::steady_clock::time_point deadline;
+    std::size_t maxNodes;   // 0 for none
+    bool stopWhenDecided;
+    const std::atomic<bool>* cancel;   // null for none
+
+    bool timed() const { return deadline != std::chrono::steady_clock::time_point::max(); }
+};
+
+// Simulations between two looks at the clock and the root statistics
+const int CHECK_INTERVAL = 16;
+
+// True if no other root child can catch up with the most visited one within
+// remaining simulations
+template<typename G>
+bool rootDecided(const BasicMCTSTree<G>& tree, double remaining) {
+    const MCTSNode& root = tree.node(tree.root());
+    if (root.numChildren == 1) {
+        return true;
+    }
+    int best = 0;
+    int second = 0;
+    for (int i = 0; i < root.numChildren; ++i) {
+        int visits = tree.visits(root.firstChild + i);
+        if (visits > best) {
+            second = best;
+            best = visits;
+        } else if (visits > second) {
+            second = visits;
+        }
+    }
+    return root.numChildren > 1 && best - second > remaining;
+}
+
+// True if batchSize more expansions could take the tree past maxNodes (0 for
+// no limit)
+template<typename G>
+bool treeFull(const BasicMCTSTree<G>& tree, G* game, std::size_t maxNodes, int batchSize) {
+    std::size_t batchNodes = static_cast<std::size_t>(std::max(batchSize, 1)) * GameTraits<G>::actionSize(*game);
+    return maxNodes > 0 && tree.size() + batchNodes > maxNodes;
+}
+
+// Runs simulations on one shared tree until budget is used up and returns
+// how many completed. Each worker gathers up to batchSize leaves per model
+// call. With several threads the caller's thread works too. Whenever
+// simulations overlap, selected paths carry virtual loss so they spread
+// over different leaves.
+template<typename G>
+int runSimulations(BasicMCTSTree<G>& tree, G* game, Model* model, const EvaluationCaches& caches,
+                   const Budget& budget, int numThreads, int batchSize, SearchStats& stats) {
+    batchSize = std::max(batchSize, 1);
+    int virtualLoss = (numThreads > 1 || batchSize > 1) ? VIRTUAL_LOSS : 0;
+    // Waiting on a leaf is only safe when it cannot be in our own batch
+    bool waitOnCollision = batchSize == 1;
+    bool checkClock = budget.timed() || budget.stopWhenDecided;
+    auto start = std::chrono::steady_clock::now();
+
+    std::atomic<long long> claimed(0);
+    std::atomic<int> done(0);
+    std::atomic<bool> stopped(false);
+    std::atomic<bool> decided(false);
+
+    // Limits other than the simulation count apply once one simulation is
+    // done, so there is always a policy to return. Reading the tree size is
+    // cheap and done before every batch; the clock and the root only every
+    // CHECK_INTERVAL simulations.
+    auto outOfBudget = [&](int& unchecked) {
+        int completed = done.load(std::memory_order_relaxed);
+        if (completed == 0) {
+            return false;
+        }
+        if (treeFull(tree, game, budget.maxNodes, batchSize)) {
+            return true;
+        }
+        if (!checkClock || unchecked < CHECK_INTERVAL) {
+            return false;
+        }
+        unchecked = 0;
+        auto now = std::chrono::steady_clock::now();
+        if (now >= budget.deadline) {
+            return true;
+        }
+        if (budget.stopWhenDecided) {
+            double remaining = static_cast<double>(budget.simulations) - completed;
+            if (budget.timed()) {
+                // Simulations that fit before the deadline at the rate so far
+                double elapsed = std::chrono::duration<double>(now - start).count();
+                double left = std::chrono::duration<double>(budget.deadline - now).count();
+                remaining = std::min(remaining, completed * left / std::max(elapsed, 1e-9));
+            }
+            if (rootDecided(tree, remaining)) {
+                decided.store(true, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<SearchStats> workerStats(std::max(numThreads, 1));
+    auto worker = [&](int t) {
+        LeafBatch batch;
+        int unchecked = 0;
+        while (!stopped.load(std::memory_order_relaxed)) {
+            if (budget.cancel && budget.cancel->load(std::memory_order_relaxed)) {
+                break;
+            }
+            if (outOfBudget(unchecked)) {
+                stopped.store(true, std::memory_order_relaxed);
+                break;
+            }
+            long long first = claimed.fetch_add(batchSize, std::memory_order_relaxed);
+            if (first >= budget.simulations) {
+                break;
+            }
+            int wanted = static_cast<int>(std::min<long long>(batchSize, budget.simulations - first));
+            int completed = runBatch(tree, game, model, caches, wanted, virtualLoss, waitOnCollision, batch,
+                                     workerStats[t]);
+            done.fetch_add(completed, std::memory_order_relaxed);
+            unchecked += std::max(completed, 1);
+            if (completed < wanted) {
+                // Hand back the simulations lost to collisions
+                claimed.fetch_sub(wanted - completed, std::memory_order_relaxed);
+                if (completed == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    helpers.reserve(std::max(numThreads - 1, 0));
+    for (int t = 1; t < numThreads; ++t) {
+        helpers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    for (const SearchStats& counts : workerStats) {
+        stats.merge(counts);
+    }
+    if (decided) {
+        stats.decidedStops = 1;
+    }
+    return done;
+}
+
+// The budget of tree t of numTrees that search under limits together
+Budget limitBudget(const SearchLimits& limits, int numTrees, int t);
+
+// Takes the simulations of root noise out of a budget
+void spend(Budget& budget, int simulations);
+
+// Throws unless limits would stop the search
+void checkLimits(const SearchLimits& limits);
+
+// Adds the size of a searched tree to stats; nodesBefore of its nodes were
+// there before the search started, less any the search released
+template<typename G>
+void addTreeStats(SearchStats& stats, const BasicMCTSTree<G>& tree, long long nodesBefore) {
+    stats.nodesAllocated += static_cast<long long>(tree.size()) - nodesBefore;
+    stats.treeNodes += static_cast<long long>(tree.size());
+    stats.liveBytes += static_cast<long long>(tree.liveBytes());
+    stats.treeBytes += static_cast<long long>(tree.bytes());
+}
+
+void finishStats(SearchStats& stats, std::chrono::steady_clock::time_point start);
+
+// Adds the visit counts of the root's children to visits, by action
+template<typename G>
+void addRootVisits(const BasicMCTSTree<G>& tree, std::vector<float>& visits) {
+    const MCTSNode& root = tree.node(tree.root());
+    for (int i = 0; i < root.numChildren; ++i) {
+        NodeIndex child = root.firstChild + i;
+        visits[tree.action(child)] += static_cast<float>(tree.visits(child));
+    }
+}
+
+// Calculate action probabilities based on visit counts
+std::vector<float> normalizeVisits(std::vector<float> probs);
+
+template<typename G>
+std::vector<float> rootVisitProbs(const BasicMCTSTree<G>& tree, int actionSpaceSize) {
+    std::vector<float> visits(actionSpaceSize, 0.0f);
+    addRootVisits(tree, visits);
+    return normalizeVisits(std::move(visits));
+}
+
+// Root noise for the independent trees of a root-parallel search when the
+// caller has not configured any: enough to make the trees explore
+// differently without burying the priors
+const float ROOT_PARALLEL_ALPHA = 0.3f;
+const float ROOT_PARALLEL_FRACTION = 0.25f;
+
+}
+
+template<typename G>
+BasicMCTSTree<G>::BasicMCTSTree(G* game, float explorationWeight)
+    : game(game), explorationWeight(explorationWeight), lazy(false), rootMoved(false), rootIdx(NO_NODE) {
+}
+
+template<typename G>
+void BasicMCTSTree<G>::reset(const GameState& state) {
+    arena.reset();
+    rootMoved = false;
+    rootIdx = arena.allocate(1);
+    arena.setNode(rootIdx, arena.allocateNode());
+
+    MCTSNode& root = arena[rootIdx];
+    root.state = state;
+    root.parent = NO_NODE;
+    root.firstChild = NO_NODE;
+    root.numChildren = 0;
+    root.player = 1;
+    root.reward = 0.0f;
+    arena.action(rootIdx) = -1;
+    arena.prior(rootIdx) = 1.0f;
+    arena.visits(rootIdx).store(0, std::memory_order_relaxed);
+    arena.valueSum(rootIdx).store(0.0f, std::memory_order_relaxed);
+    arena.expansion(rootIdx).store(LEAF, std::memory_order_relaxed);
+}
+
+template<typename G>
+bool BasicMCTSTree<G>::empty() const {
+    return rootIdx == NO_NODE;
+}
+
+template<typename G>
+void BasicMCTSTree<G>::setRoot(NodeIndex index) {
+    rootMoved = rootMoved || index != rootIdx;
+    rootIdx = index;
+    arena[rootIdx].parent = NO_NODE;
+}
+
+template<typename G>
+void BasicMCTSTree<G>::compact() {
+    if (!rootMoved) {
+        return;
+    }
+    spare.reset();
+    NodeIndex newRoot = spare.allocate(1);
+    spare.setNode(newRoot, spare.allocateNode());
+    spare[newRoot] = arena[rootIdx];
+    spare[newRoot].parent = NO_NODE;
+    copyStats(rootIdx, newRoot);
+
+    // Breadth-first copy, one child block at a time, so siblings stay contiguous
+    std::deque<NodeIndex> pending = {newRoot};
+    while (!pending.empty()) {
+        NodeIndex parent = pending.front();
+        pending.pop_front();
+
+        MCTSNode& copy = spare[parent];
+        if (copy.numChildren == 0) {
+            continue;
+        }
+
+        NodeIndex block = spare.allocate(copy.numChildren);
+        for (int i = 0; i < copy.numChildren; ++i) {
+            NodeIndex from = copy.firstChild + i;
+            copyStats(from, block + i);
+            if (!arena.hasNode(from)) {
+                // Never selected; stays an edge
+                spare.setNode(block + i, nullptr);
+                continue;
+            }
+            spare.setNode(block + i, spare.allocateNode());
+            spare[block + i] = arena[from];
+            spare[block + i].parent = parent;
+            pending.push_back(block + i);
+        }
+        copy.firstChild = block;
+    }
+
+    arena.swap(spare);
+    spare.reset();
+    rootIdx = newRoot;
+    rootMoved = false;
+}
+
+template<typename G>
+int BasicMCTSTree<G>::collapse(std::size_t maxNodes) {
+    if (empty() || arena.size() <= maxNodes) {
+        return 0;
+    }
+
+    // Every expanded node below the root, least visited first. A node has
+    // more visits than any of its children, and ties go to the deeper node,
+    // so a subtree always comes before the subtrees containing it.
+    struct Candidate {
+        int visits;
+        int depth;
+        NodeIndex index;
+    };
+    std::vector<Candidate> candidates;
+    std::vector<std::pair<NodeIndex, int>> pending = {{rootIdx, 0}};
+    while (!pending.empty()) {
+        auto [index, depth] = pending.back();
+        pending.pop_back();
+        const MCTSNode& n = arena[index];
+        for (int i = 0; i < n.numChildren; ++i) {
+            NodeIndex child = n.firstChild + i;
+            if (arena.hasNode(child) && arena[child].numChildren > 0) {
+                candidates.push_back({arena.visits(child), depth + 1, child});
+                pending.emplace_back(child, depth + 1);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.visits != b.visits ? a.visits < b.visits : a.depth > b.depth;
+    });
+
+    int collapsed = 0;
+    for (const Candidate& candidate : candidates) {
+        if (arena.size() <= maxNodes) {
+            break;
+        }
+        releaseChildren(candidate.index);
+        collapsed++;
+    }
+    return collapsed;
+}
+
+template<typename G>
+void BasicMCTSTree<G>::releaseChildren(NodeIndex index) {
+    // Walks node pointers rather than slots, so nothing is read after it
+    // has been released
+    MCTSNode& top = arena[index];
+    std::vector<MCTSNode*> pending = {&top};
+    while (!pending.empty()) {
+        MCTSNode* n = pending.back();
+        pending.pop_back();
+        for (int i = 0; i < n->numChildren; ++i) {
+            NodeIndex child = n->firstChild + i;
+            if (!arena.hasNode(child)) {
+                continue;
+            }
+            MCTSNode* childNode = &arena[child];
+            if (childNode->numChildren > 0) {
+                pending.push_back(childNode);
+            } else {
+                arena.releaseNode(childNode);
+            }
+        }
+        arena.release(n->firstChild, n->numChildren);
+        if (n != &top) {
+            arena.releaseNode(n);
+        }
+    }
+
+    top.firstChild = NO_NODE;
+    top.numChildren = 0;
+    arena.expansion(index).store(LEAF, std::memory_order_relaxed);
+}
+
+template<typename G>
+void BasicMCTSTree<G>::save(const std::string& path, NodeIndex from) const {
+    if (from == NO_NODE) {
+        from = rootIdx;
+    }
+    if (from == NO_NODE) {
+        throw std::logic_error("Cannot save an empty tree");
+    }
+
+    TreeFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    const GameState& state = arena[from].state;
+    header.actionSize = static_cast<uint32_t>(GameTraits<G>::actionSize(*game));
+    header.stateSize = static_cast<uint32_t>(GameTraits<G>::stateSize(*game));
+    header.boardBytes = static_cast<uint32_t>(GameState::CAPACITY);
+    header.rootHash = state.hash;
+    std::memcpy(header.rootBoard, state.storage, sizeof(header.rootBoard));
+    header.rootTerminal = state.isTerminal ? 1 : 0;
+
+    // Breadth-first, the order restore() rebuilds the tree in
+    std::vector<TreeFileRecord> records;
+    std::deque<NodeIndex> pending = {from};
+    while (!pending.empty()) {
+        NodeIndex index = pending.front();
+        pending.pop_front();
+
+        TreeFileRecord record = {};
+        record.prior = arena.prior(index);
+        record.visits = arena.visits(index);
+        record.valueSum = arena.valueSum(index);
+        record.action = index == from ? -1 : arena.action(index);
+        if (arena.hasNode(index)) {
+            record.flags = TreeFile::BUILT;
+            if (arena.expansion(index) == EXPANDED) {
+                const MCTSNode& n = arena[index];
+                record.flags |= TreeFile::EXPANDED;
+                record.numChildren = static_cast<uint16_t>(n.numChildren);
+                int childVisits = 0;
+                for (int i = 0; i < n.numChildren; ++i) {
+                    childVisits += arena.visits(n.firstChild + i);
+                    pending.push_back(n.firstChild + i);
+                }
+                if (index == from) {
+                    // A root reached by setRoot() only counts the visits it
+                    // got as a child, and load() rejects children with more
+                    // visits than their parent
+                    record.visits = std::max(record.visits, childVisits);
+                }
+            }
+        }
+        records.push_back(record);
+    }
+
+    TreeFile::write(path, header, records);
+}
+
+template<typename G>
+void BasicMCTSTree<G>::load(const std::string& path) {
+    std::vector<TreeFileRecord> records;
+    TreeFileHeader header = TreeFile::read(path, records);
+    if (header.actionSize != static_cast<uint32_t>(GameTraits<G>::actionSize(*game)) ||
+        header.stateSize != static_cast<uint32_t>(GameTraits<G>::stateSize(*game)) ||
+        header.boardBytes != GameState::CAPACITY) {
+        throw std::invalid_argument(path + " holds a tree of another game");
+    }
+
+    GameState state;
+    std::memcpy(state.storage, header.rootBoard, sizeof(header.rootBoard));
+    state.hash = header.rootHash;
+    state.isTerminal = header.rootTerminal != 0;
+    if (game->computeHash(state) != state.hash) {
+        throw std::invalid_argument(path + " holds a tree of another game");
+    }
+
+    reset(state);
+    try {
+        restore(path, records);
+    } catch (...) {
+        arena.reset();
+        rootIdx = NO_NODE;
+        throw;
+    }
+}
+
+template<typename G>
+void BasicMCTSTree<G>::restore(const std::string& path, const std::vector<TreeFileRecord>& records) {
+    auto corrupt = [&]() {
+        return std::invalid_argument("Corrupt tree file " + path);
+    };
+    auto badStats = [](const TreeFileRecord& record) {
+        return record.visits < 0 || !std::isfinite(record.prior) || record.prior < 0 ||
+               !std::isfinite(record.valueSum);
+    };
+    auto setStats = [&](NodeIndex index, const TreeFileRecord& record) {
+        arena.prior(index) = record.prior;
+        arena.visits(index).store(record.visits, std::memory_order_relaxed);
+        arena.valueSum(index).store(record.valueSum, std::memory_order_relaxed);
+    };
+
+    if (badStats(records[0])) {
+        throw corrupt();
+    }
+    setStats(rootIdx, records[0]);
+    std::size_t next = 1;
+    // Record of the parent whose block last had each action, to catch an
+    // action given twice in one block
+    std::vector<std::size_t> seenIn(GameTraits<G>::actionSize(*game), 0);
+    std::deque<std::pair<NodeIndex, std::size_t>> pending = {{rootIdx, 0}};
+    while (!pending.empty()) {
+        auto [index, r] = pending.front();
+        pending.pop_front();
+        const TreeFileRecord& record = records[r];
+        if (!(record.flags & TreeFile::EXPANDED)) {
+            if (record.numChildren != 0) {
+                throw corrupt();
+            }
+            continue;
+        }
+
+        int count = record.numChildren;
+        if (count > GameTraits<G>::actionSize(*game) || count > static_cast<int>(records.size() - next)) {
+            throw corrupt();
+        }
+        if (count > 0) {
+            NodeIndex block = arena.allocate(count);
+            for (int i = 0; i < count; ++i) {
+                const TreeFileRecord& childRecord = records[next + i];
+                NodeIndex child = block + static_cast<NodeIndex>(i);
+                if (childRecord.action < 0 || childRecord.action >= GameTraits<G>::actionSize(*game) ||
+                    seenIn[childRecord.action] == r + 1 ||
+                    !game->isValidAction(arena[index].state, childRecord.action) ||
+                    badStats(childRecord) || childRecord.visits > record.visits ||
+                    ((childRecord.flags & TreeFile::EXPANDED) && !(childRecord.flags & TreeFile::BUILT))) {
+                    throw corrupt();
+                }
+                seenIn[childRecord.action] = r + 1;
+                arena.action(child) = childRecord.action;
+                setStats(child, childRecord);
+                arena.expansion(child).store(LEAF, std::memory_order_relaxed);
+                if ((childRecord.flags & TreeFile::BUILT) || !lazy) {
+                    MCTSNode* node = arena.allocateNode();
+                    buildNode(*node, arena[index], index, childRecord.action);
+                    arena.setNode(child, node);
+                    pending.emplace_back(child, next + i);
+                } else {
+                    arena.setNode(child, nullptr);
+                }
+            }
+            arena[index].firstChild = block;
+            arena[index].numChildren = count;
+            next += count;
+        }
+        arena.expansion(index).store(EXPANDED, std::memory_order_relaxed);
+    }
+
+    if (next != records.size()) {
+        throw corrupt();
+    }
+}
+
+template<typename G>
+void BasicMCTSTree<G>::copyStats(NodeIndex from, NodeIndex to) {
+    const NodeArena& source = arena;
+    spare.action(to) = source.action(from);
+    spare.prior(to) = source.prior(from);
+    spare.visits(to).store(source.visits(from), std::memory_order_relaxed);
+    spare.valueSum(to).store(source.valueSum(from), std::memory_order_relaxed);
+    spare.expansion(to).store(source.expansion(from), std::memory_order_relaxed);
+}
+
+template<typename G>
+bool BasicMCTSTree<G>::isFullyExpanded(NodeIndex index) const {
+    return arena.expansion(index) == EXPANDED ||
+           (arena[index].state.isTerminal && arena.visits(index) > 0);
+}
+
+template<typename G>
+bool BasicMCTSTree<G>::tryBeginExpand(NodeIndex index) {
+    int8_t expected = LEAF;
+    return arena.expansion(index).compare_exchange_strong(expected, EXPANDING, std::memory_order_acquire);
+}
+
+template<typename G>
+void BasicMCTSTree<G>::waitForExpansion(NodeIndex index) const {
+    while (arena.expansion(index) != EXPANDED) {
+        std::this_thread::yield();
+    }
+}
+
+template<typename G>
+float BasicMCTSTree<G>::getUCB(NodeIndex parent, NodeIndex child) const {
+    int childVisits = arena.visits(child);
+
+    float qValue = 0.0f;
+    if (childVisits > 0) {
+        qValue = -arena.valueSum(child) / childVisits;
+    }
+
+    return qValue + explorationWeight * arena.prior(child) *
+           (std::sqrt(static_cast<float>(arena.visits(parent))) / (1.0f + childVisits));
+}
+
+template<typename G>
+NodeIndex BasicMCTSTree<G>::bestChild(NodeIndex index) const {
+    const MCTSNode& n = arena[index];
+    if (n.numChildren == 0) {
+        return NO_NODE;
+    }
+
+    // Same scores as getUCB, computed over the sibling arrays in one pass
+    float sqrtVisits = std::sqrt(static_cast<float>(arena.visits(index)));
+    return n.firstChild + puctArgmax(arena.priors(n.firstChild),
+                                     arena.visitCounts(n.firstChild),
+                                     arena.valueSums(n.firstChild),
+                                     n.numChildren, explorationWeight, sqrtVisits);
+}
+
+template<typename G>
+void BasicMCTSTree<G>::expand(NodeIndex index, const float* policy) {
+    typename GameTraits<G>::Actions validActions = GameTraits<G>::validActions(*game, arena[index].state);
+    int numValid = static_cast<int>(validActions.size());
+    if (numValid == 0) {
+        arena.expansion(index).store(EXPANDED, std::memory_order_release);
+        return;
+    }
+
+    NodeIndex block = arena.allocate(numValid);
+    MCTSNode& parent = arena[index];
+
+    for (int i = 0; i < numValid; ++i) {
+        int action = validActions[i];
+        NodeIndex childIdx = block + static_cast<NodeIndex>(i);
+        if (lazy) {
+            arena.setNode(childIdx, nullptr);
+        } else {
+            MCTSNode* child = arena.allocateNode();
+            buildNode(*child, parent, index, action);
+            arena.setNode(childIdx, child);
+        }
+
+        arena.action(childIdx) = action;
+        arena.prior(childIdx) = policy[action];
+        arena.visits(childIdx).store(0, std::memory_order_relaxed);
+        arena.valueSum(childIdx).store(0.0f, std::memory_order_relaxed);
+        arena.expansion(childIdx).store(LEAF, std::memory_order_relaxed);
+    }
+
+    parent.firstChild = block;
+    parent.numChildren = numValid;
+
+    // Publish the children to threads selecting through this node
+    arena.expansion(index).store(EXPANDED, std::memory_order_release);
+}
+
+template<typename G>
+void BasicMCTSTree<G>::buildNode(MCTSNode& child, const MCTSNode& parent, NodeIndex parentIdx, int action) {
+    auto [newState, r] = game->move(parent.state, action);
+    child.state = game->flipBoard(newState);
+    child.parent = parentIdx;
+    child.firstChild = NO_NODE;
+    child.numChildren = 0;
+    child.player = -parent.player;
+    child.reward = game->getOpponentReward(r);
+}
+
+template<typename G>
+void BasicMCTSTree<G>::buildChild(NodeIndex parent, NodeIndex child) {
+    if (arena.hasNode(child)) {
+        return;
+    }
+    MCTSNode* node = arena.allocateNode();
+    buildNode(*node, arena[parent], parent, arena.action(child));
+    // If another thread built the same child meanwhile, its node is kept
+    if (!arena.publishNode(child, node)) {
+        arena.releaseNode(node);
+    }
+}
+
+template<typename G>
+NodeIndex BasicMCTSTree<G>::selectChild(NodeIndex index) {
+    NodeIndex child = bestChild(index);
+    buildChild(index, child);
+    return child;
+}
+
+template<typename G>
+void BasicMCTSTree<G>::addVirtualLoss(NodeIndex index, int virtualLoss) {
+    // Counted as visits that the player to move at index won, which makes
+    // the node look worse to its parent until the real result comes back
+    arena.visits(index).fetch_add(virtualLoss, std::memory_order_relaxed);
+    atomicAdd(arena.valueSum(index), static_cast<float>(virtualLoss));
+}
+
+template<typename G>
+void BasicMCTSTree<G>::removeVirtualLoss(const NodeIndex* path, int length, int virtualLoss) {
+    for (int i = 0; i < length; ++i) {
+        arena.visits(path[i]).fetch_sub(virtualLoss, std::memory_order_relaxed);
+        atomicAdd(arena.valueSum(path[i]), -static_cast<float>(virtualLoss));
+    }
+}
+
+template<typename G>
+void BasicMCTSTree<G>::backpropagate(const NodeIndex* path, int length, float value, int virtualLoss) {
+    // Players alternate along the path, so the value seen from each node is
+    // one of these two. With a concrete G the flip is inlined.
+    const float values[2] = {value, game->getOpponentReward(value)};
+    for (int i = length - 1, side = 0; i >= 0; --i, side ^= 1) {
+        arena.visits(path[i]).fetch_add(1 - virtualLoss, std::memory_order_relaxed);
+        atomicAdd(arena.valueSum(path[i]), values[side] - virtualLoss);
+    }
+}
+
+template<typename G>
+void BasicMCTSTree<G>::backpropagate(NodeIndex index, float value, int virtualLoss) {
+    const float values[2] = {value, game->getOpponentReward(value)};
+    for (int side = 0; index != NO_NODE; side ^= 1) {
+        arena.visits(index).fetch_add(1 - virtualLoss, std::memory_order_relaxed);
+        atomicAdd(arena.valueSum(index), values[side] - virtualLoss);
+        index = arena[index].parent;
+    }
+}
+
+template<typename G>
+void BasicMCTSTree<G>::print(NodeIndex index, int depth) const {
+    const MCTSNode& n = arena[index];
+    std::string indent(depth * 2, ' ');
+    std::string playerStr = (n.player == 1) ? "AI" : "H";
+    std::cout << indent << playerStr << "(id=" << index
+              << ", action_taken=" << arena.action(index)
+              << ", value_sum=" << arena.valueSum(index)
+              << ", visits=" << arena.visits(index)
+              << ", reward=" << n.reward << ")" << std::endl;
+
+    for (int i = 0; i < n.numChildren; ++i) {
+        if (arena.hasNode(n.firstChild + i)) {
+            print(n.firstChild + i, depth + 1);
+        }
+    }
+}
+
+template<typename G>
+std::size_t BasicMCTSTree<G>::size() const {
+    return arena.size();
+}
+
+template<typename G>
+std::size_t BasicMCTSTree<G>::liveBytes() const {
+    return arena.liveBytes();
+}
+
+template<typename G>
+std::size_t BasicMCTSTree<G>::bytes() const {
+    return arena.bytes() + spare.bytes();
+}
+
+template<typename G>
+BasicMCTS<G>::BasicMCTS(G* game, Model* model, int numSimulations, float explorationWeight,
+                        int numThreads, int batchSize)
+    : game(game), model(model), numSimulations(numSimulations),
+      explorationWeight(explorationWeight), numThreads(numThreads), batchSize(batchSize),
+      tree(game, explorationWeight), evaluationCache(nullptr), rootNoise{0.0f, 0.0f, std::mt19937_64()},
+      completedSimulations(0), noisePending(false) {
+    tree.setLazyExpansion(true);
+}
+
+template<typename G>
+void BasicMCTS<G>::setLazyExpansion(bool enabled) {
+    tree.setLazyExpansion(enabled);
+    for (RootTree& rootTree : rootTrees) {
+        rootTree.tree->setLazyExpansion(enabled);
+    }
+}
+
+template<typename G>
+void BasicMCTS<G>::enableTranspositionTable(std::size_t bytes) {
+    transpositions = std::make_unique<TranspositionTable>(bytes, GameTraits<G>::actionSize(*game));
+}
+
+template<typename G>
+void BasicMCTS<G>::setEvaluationCache(EvaluationCache* cache) {
+    if (cache && cache->actionSize() != GameTraits<G>::actionSize(*game)) {
+        throw std::invalid_argument("Evaluation cache does not match the action space");
+    }
+    evaluationCache = cache;
+}
+
+template<typename G>
+void BasicMCTS<G>::setRootNoise(float alpha, float fraction, uint64_t seed) {
+    if (fraction > 0.0f && alpha <= 0.0f) {
+        throw std::invalid_argument("Dirichlet alpha must be positive");
+    }
+    rootNoise.alpha = alpha;
+    rootNoise.fraction = fraction;
+    rootNoise.rng.seed(seed);
+}
+
+template<typename G>
+void BasicMCTS<G>::prepareSearch() {
+    if (transpositions) {
+        transpositions->newSearch();
+    }
+    if (evaluationCache) {
+        evaluationCache->setModelVersion(model->version());
+    }
+}
+
+template<typename G>
+void BasicMCTS<G>::setRootParallel(int numTrees, uint64_t seed) {
+    rootTrees.clear();
+    for (int t = 0; numTrees > 1 && t < numTrees; ++t) {
+        RootNoise noise = {mctsDetail::ROOT_PARALLEL_ALPHA, mctsDetail::ROOT_PARALLEL_FRACTION,
+                           std::mt19937_64(seed + t)};
+        rootTrees.push_back({std::make_unique<Tree>(game, explorationWeight), noise});
+        rootTrees.back().tree->setLazyExpansion(tree.lazyExpansion());
+    }
+}
+
+// Every tree searches its share of numSimulations on its own thread and
+// with its own arena and noise. The root visit counts are added up by action.
+template<typename G>
+std::vector<float> BasicMCTS<G>::searchRootParallel(const GameState& state, const SearchLimits& limits,
+                                            SearchStats& stats) {
+    prepareSearch();
+    mctsDetail::EvaluationCaches caches = {transpositions.get(), evaluationCache};
+    int numTrees = static_cast<int>(rootTrees.size());
+    std::vector<SearchStats> treeStats(numTrees);
+
+    auto worker = [&](int t) {
+        Tree& treeT = *rootTrees[t].tree;
+        RootNoise& noise = rootTrees[t].noise;
+        if (rootNoise.fraction > 0.0f) {
+            noise.alpha = rootNoise.alpha;
+            noise.fraction = rootNoise.fraction;
+        }
+        treeT.reset(state);
+        mctsDetail::Budget budget = mctsDetail::limitBudget(limits, numTrees, t);
+        int used = mctsDetail::applyRootNoise(treeT, game, model, caches, noise, treeStats[t]);
+        mctsDetail::spend(budget, used);
+        treeStats[t].simulations = used + mctsDetail::runSimulations(treeT, game, model, caches, budget, 1,
+                                                                     batchSize, treeStats[t]);
+    };
+
+    std::vector<std::thread> helpers;
+    helpers.reserve(numTrees - 1);
+    for (int t = 1; t < numTrees; ++t) {
+        helpers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    std::vector<float> visits(GameTraits<G>::actionSize(*game), 0.0f);
+    for (int t = 0; t < numTrees; ++t) {
+        mctsDetail::addRootVisits(*rootTrees[t].tree, visits);
+        stats.merge(treeStats[t]);
+        mctsDetail::addTreeStats(stats, *rootTrees[t].tree, 0);
+    }
+    // One search, however many of its trees stopped early
+    stats.decidedStops = std::min(stats.decidedStops, 1LL);
+    return mctsDetail::normalizeVisits(std::move(visits));
+}
+
+template<typename G>
+std::vector<float> BasicMCTS<G>::search(const GameState& state, SearchStats* stats) {
+    SearchLimits limits;
+    limits.simulations = std::max(numSimulations, 1);
+    return search(state, limits, stats);
+}
+
+template<typename G>
+std::vector<float> BasicMCTS<G>::search(const GameState& state, const SearchLimits& limits, SearchStats* stats) {
+    mctsDetail::checkLimits(limits);
+    auto start = std::chrono::steady_clock::now();
+    SearchStats searchStats;
+    std::vector<float> probs;
+
+    if (!rootTrees.empty()) {
+        probs = searchRootParallel(state, limits, searchStats);
+    } else {
+        // Reuses the arena of the previous search; nothing is freed node by node
+        tree.reset(state);
+        prepareSearch();
+
+        mctsDetail::EvaluationCaches caches = {transpositions.get(), evaluationCache};
+        mctsDetail::Budget budget = mctsDetail::limitBudget(limits, 1, 0);
+        int used = mctsDetail::applyRootNoise(tree, game, model, caches, rootNoise, searchStats);
+        mctsDetail::spend(budget, used);
+        searchStats.simulations = used + mctsDetail::runSimulations(tree, game, model, caches, budget, numThreads,
+                                                                    batchSize, searchStats);
+        mctsDetail::addTreeStats(searchStats, tree, 0);
+        probs = mctsDetail::rootVisitProbs(tree, GameTraits<G>::actionSize(*game));
+    }
+
+    if (stats != nullptr) {
+        mctsDetail::finishStats(searchStats, start);
+        *stats = searchStats;
+    }
+    return probs;
+}
+
+template<typename G>
+void BasicMCTS<G>::beginSearch(const GameState& state) {
+    searchStart = std::chrono::steady_clock::now();
+    currentStats = SearchStats();
+    tree.reset(state);
+    prepareSearch();
+    completedSimulations = 0;
+    noisePending = mctsDetail::wantsRootNoise(tree, rootNoise);
+    pendingPath.clear();
+}
+
+template<typename G>
+const GameState* BasicMCTS<G>::nextLeaf() {
+    if (!pendingPath.empty()) {
+        throw std::logic_error("The previous leaf has not been evaluated");
+    }
+
+    mctsDetail::EvaluationCaches caches = {transpositions.get(), evaluationCache};
+    while (completedSimulations < numSimulations) {
+        // Noise goes in as soon as the root has children, as in search()
+        if (noisePending && completedSimulations > 0) {
+            mctsDetail::mixRootNoise(tree, rootNoise);
+            noisePending = false;
+        }
+
+        mctsDetail::LeafKind kind = mctsDetail::selectLeaf(tree, 0, true, pendingPath, currentStats);
+        NodeIndex leaf = pendingPath.back();
+        int length = static_cast<int>(pendingPath.size());
+        if (kind == mctsDetail::LeafKind::TERMINAL) {
+            if (SEARCH_PROFILING) currentStats.terminalLeaves++;
+            PhaseTimer timer(currentStats.backpropagationSeconds);
+            tree.backpropagate(pendingPath.data(), length, tree.node(leaf).reward);
+            pendingPath.clear();
+            completedSimulations++;
+            continue;
+        }
+
+        if (caches.enabled()) {
+            evaluated.resize(GameTraits<G>::actionSize(*game));
+            float value;
+            if (caches.lookup(tree.node(leaf).state.hash, evaluated.data(), value)) {
+                if (SEARCH_PROFILING) currentStats.cacheHits++;
+                {
+                    PhaseTimer timer(currentStats.expansionSeconds);
+                    tree.expand(leaf, evaluated.data());
+                }
+                PhaseTimer timer(currentStats.backpropagationSeconds);
+                tree.backpropagate(pendingPath.data(), length, value);
+                pendingPath.clear();
+                completedSimulations++;
+                continue;
+            }
+        }
+
+        if (SEARCH_PROFILING) leafReturned = std::chrono::steady_clock::now();
+        return &tree.node(leaf).state;
+    }
+
+    if (noisePending) {
+        // Keeps the noise generator in step with search()
+        mctsDetail::mixRootNoise(tree, rootNoise);
+        noisePending = false;
+    }
+    if (currentStats.searches == 0) {
+        mctsDetail::addTreeStats(currentStats, tree, 0);
+        currentStats.simulations = completedSimulations;
+        mctsDetail::finishStats(currentStats, searchStart);
+    }
+    return nullptr;
+}
+
+template<typename G>
+void BasicMCTS<G>::evaluate(const float* policy, float value) {
+    if (pendingPath.empty()) {
+        throw std::logic_error("No leaf is waiting for an evaluation");
+    }
+    if (SEARCH_PROFILING) {
+        currentStats.evaluationSeconds +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - leafReturned).count();
+        currentStats.modelEvaluations++;
+    }
+    evaluated.assign(policy, policy + GameTraits<G>::actionSize(*game));
+    mctsDetail::EvaluationCaches caches = {transpositions.get(), evaluationCache};
+    mctsDetail::expandEvaluated(tree, game, caches, pendingPath.data(), static_cast<int>(pendingPath.size()),
+                                  evaluated.data(), value, 0, currentStats);
+    pendingPath.clear();
+    completedSimulations++;
+}
+
+template<typename G>
+std::vector<float> BasicMCTS<G>::searchResult(SearchStats* stats) const {
+    if (stats != nullptr) {
+        *stats = currentStats;
+    }
+    return mctsDetail::rootVisitProbs(tree, GameTraits<G>::actionSize(*game));
+}
+
+
+template<typename G>
+BasicMCTS2<G>::BasicMCTS2(G* game, Model* model, int numSimulations, float explorationWeight,
+                          int numThreads, int batchSize)
+    : game(game), model(model), numSimulations(numSimulations),
+      explorationWeight(explorationWeight), numThreads(numThreads), batchSize(batchSize),
+      tree(game, explorationWeight), evaluationCache(nullptr), rootNoise{0.0f, 0.0f, std::mt19937_64()},
+      memoryLimit(0), ponderEnabled(false), ponderBytes(DEFAULT_PONDER_BYTES), ponderStop(false),
+      ponderedSimulations(0), searchedRoot(NO_NODE) {
+    tree.setLazyExpansion(true);
+}
+
+template<typename G>
+void BasicMCTS2<G>::setLazyExpansion(bool enabled) {
+    stopPondering();
+    tree.setLazyExpansion(enabled);
+}
+
+template<typename G>
+BasicMCTS2<G>::~BasicMCTS2() {
+    stopPondering();
+}
+
+template<typename G>
+void BasicMCTS2<G>::enableTranspositionTable(std::size_t bytes) {
+    stopPondering();
+    transpositions = std::make_unique<TranspositionTable>(bytes, GameTraits<G>::actionSize(*game));
+}
+
+template<typename G>
+void BasicMCTS2<G>::setEvaluationCache(EvaluationCache* cache) {
+    if (cache && cache->actionSize() != GameTraits<G>::actionSize(*game)) {
+        throw std::invalid_argument("Evaluation cache does not match the action space");
+    }
+    stopPondering();
+    evaluationCache = cache;
+}
+
+template<typename G>
+void BasicMCTS2<G>::setPondering(bool enabled, std::size_t maxBytes) {
+    stopPondering();
+    ponderEnabled = enabled;
+    ponderBytes = maxBytes;
+}
+
+template<typename G>
+void BasicMCTS2<G>::stopPondering() {
+    if (ponderThread.joinable()) {
+        ponderStop.store(true, std::memory_order_relaxed);
+        ponderThread.join();
+    }
+}
+
+template<typename G>
+void BasicMCTS2<G>::setMemoryLimit(std::size_t bytes) {
+    stopPondering();
+    memoryLimit = bytes;
+}
+
+template<typename G>
+void BasicMCTS2<G>::saveTree(const std::string& path) {
+    stopPondering();
+    if (searchedRoot == NO_NODE) {
+        throw std::logic_error("No search tree to save");
+    }
+    tree.save(path, searchedRoot);
+}
+
+template<typename G>
+void BasicMCTS2<G>::loadTree(const std::string& path) {
+    stopPondering();
+    searchedRoot = NO_NODE;
+    tree.load(path);
+    searchedRoot = tree.root();
+}
+
+template<typename G>
+std::size_t BasicMCTS2<G>::memoryNodes() const {
+    return memoryLimit > 0 ? std::max<std::size_t>(memoryLimit / NodeArena::nodeBytes(), 1) : 0;
+}
+
+// Searches under the current root, which search() left at the expected
+// move, until stopPondering() or the tree reaches ponderBytes or the memory
+// limit
+template<typename G>
+void BasicMCTS2<G>::startPondering() {
+    if (!ponderEnabled || tree.empty() || tree.node(tree.root()).state.isTerminal) {
+        return;
+    }
+    ponderStop.store(false, std::memory_order_relaxed);
+    ponderThread = std::thread([this]() {
+        mctsDetail::EvaluationCaches caches = {transpositions.get(), evaluationCache};
+        std::size_t maxNodes = std::max<std::size_t>(ponderBytes / NodeArena::nodeBytes(), 1);
+        if (memoryLimit > 0) {
+            maxNodes = std::min(maxNodes, memoryNodes());
+        }
+        mctsDetail::Budget budget = {std::numeric_limits<int>::max(), std::chrono::steady_clock::time_point::max(),
+                                     maxNodes, false, &ponderStop};
+        SearchStats unused;
+        ponderedSimulations = mctsDetail::runSimulations(tree, game, model, caches, budget, numThreads, batchSize,
+                                                         unused);
+    });
+}
+
+template<typename G>
+void BasicMCTS2<G>::setRootNoise(float alpha, float fraction, uint64_t seed) {
+    if (fraction > 0.0f && alpha <= 0.0f) {
+        throw std::invalid_argument("Dirichlet alpha must be positive");
+    }
+    rootNoise.alpha = alpha;
+    rootNoise.fraction = fraction;
+    rootNoise.rng.seed(seed);
+}
+
+template<typename G>
+std::vector<float> BasicMCTS2<G>::search(const GameState& state, SearchStats* stats) {
+    SearchLimits limits;
+    limits.simulations = std::max(numSimulations, 1);
+    return search(state, limits, stats);
+}
+
+template<typename G>
+std::vector<float> BasicMCTS2<G>::search(const GameState& state, const SearchLimits& limits, SearchStats* stats) {
+    mctsDetail::checkLimits(limits);
+    auto start = std::chrono::steady_clock::now();
+    SearchStats searchStats;
+    stopPondering();
+    searchStats.ponderSimulations = ponderedSimulations;
+    ponderedSimulations = 0;
+    searchedRoot = NO_NODE;
+
+    // check if any of the child states are equal to state 2 levels down
+    bool createNew = true;
+    if (!tree.empty() && game->checkEq(tree.node(tree.root()).state, state)) {
+        // Already at state, e.g. a tree from loadTree() or the move the
+        // previous search expected. Drops the siblings that search left.
+        tree.compact();
+        createNew = false;
+    } else if (!tree.empty()) {
+        const MCTSNode& root = tree.node(tree.root());
+        for (int i = 0; i < root.numChildren; ++i) {
+            NodeIndex child = root.firstChild + i;
+            tree.buildChild(tree.root(), child);
+            if (game->checkEq(tree.node(child).state, state)) {
+                // If we found a matching child, keep only its subtree
+                tree.setRoot(child);
+                tree.compact();
+                createNew = false;
+                break;
+            }
+        }
+    }
+
+    if(createNew)
+        tree.reset(state);
+    std::size_t nodesBefore = 0;
+    if (!createNew) {
+        nodesBefore = tree.size();
+        searchStats.reusedTrees = 1;
+        searchStats.reusedNodes = static_cast<long long>(nodesBefore);
+    }
+
+    if (transpositions) {
+        transpositions->newSearch();
+    }
+    if (evaluationCache) {
+        evaluationCache->setModelVersion(model->version());
+    }
+    mctsDetail::EvaluationCaches caches = {transpositions.get(), evaluationCache};
+    mctsDetail::Budget budget = mctsDetail::limitBudget(limits, 1, 0);
+    std::size_t limitNodes = budget.maxNodes;
+    std::size_t maxLiveNodes = memoryNodes();
+    if (maxLiveNodes > 0 && (limitNodes == 0 || maxLiveNodes < limitNodes)) {
+        budget.maxNodes = maxLiveNodes;
+    }
+    int used = mctsDetail::applyRootNoise(tree, game, model, caches, rootNoise, searchStats);
+    mctsDetail::spend(budget, used);
+    searchStats.simulations = used;
+
+    // The search runs in rounds that end when the tree reaches the memory
+    // limit. In between, with no thread in the tree, the least visited
+    // subtrees are collapsed down to three quarters of the limit.
+    while (true) {
+        int completed = mctsDetail::runSimulations(tree, game, model, caches, budget, numThreads, batchSize,
+                                                   searchStats);
+        searchStats.simulations += completed;
+        mctsDetail::spend(budget, completed);
+
+        bool onlyMemoryLeft = budget.simulations > 0 && searchStats.decidedStops == 0 &&
+                              std::chrono::steady_clock::now() < budget.deadline &&
+                              mctsDetail::treeFull(tree, game, maxLiveNodes, batchSize) &&
+                              !mctsDetail::treeFull(tree, game, limitNodes, batchSize);
+        if (!onlyMemoryLeft) {
+            break;
+        }
+        std::size_t nodesLive = tree.size();
+        searchStats.collapsedSubtrees += tree.collapse(maxLiveNodes - maxLiveNodes / 4);
+        if (mctsDetail::treeFull(tree, game, maxLiveNodes, batchSize)) {
+            // Only nodes outside the root's subtree are left to release
+            tree.compact();
+        }
+        searchStats.collapsedNodes += static_cast<long long>(nodesLive - tree.size());
+        if (mctsDetail::treeFull(tree, game, maxLiveNodes, batchSize)) {
+            // The root's children and one batch alone exceed the limit
+            searchStats.memoryStops = 1;
+            break;
+        }
+    }
+
+    std::vector<float> probs = mctsDetail::rootVisitProbs(tree, GameTraits<G>::actionSize(*game));
+    if (stats != nullptr) {
+        mctsDetail::addTreeStats(searchStats, tree, static_cast<long long>(nodesBefore) - searchStats.collapsedNodes);
+        mctsDetail::finishStats(searchStats, start);
+        *stats = searchStats;
+    }
+
+    // !ASSUMPTION
+    // assume that game continues and we pick highest prob state
+    int bestAction = 0;
+    float bestProb = probs[0];
+    for (size_t i = 1; i < probs.size(); ++i) {
+        if (probs[i] > bestProb) {
+            bestProb = probs[i];
+            bestAction = static_cast<int>(i);
+        }
+    }
+    searchedRoot = tree.root();
+    const MCTSNode& root = tree.node(tree.root());
+    for (int i = 0; i < root.numChildren; ++i) {
+        NodeIndex child = root.firstChild + i;
+        if (tree.action(child) == bestAction) {
+            tree.buildChild(tree.root(), child);
+            tree.setRoot(child);
+            break;
+        }
+    }
+
+    startPondering();
+    return probs;
+}
+
+#endif // MCTS_IMPL_H
\ No newline at end of file
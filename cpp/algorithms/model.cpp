@@ -0,0 +1,16 @@
+#include "model.h"
+#include <algorithm>
+#include <cstddef>
+
+void Model::predictBatch(const float* states, int batchSize, int stateSize,
+                         float* policies, int actionSize, float* values) {
+    std::vector<float> encodedState(stateSize);
+    for (int i = 0; i < batchSize; ++i) {
+        const float* state = states + static_cast<size_t>(i) * stateSize;
+        std::copy(state, state + stateSize, encodedState.begin());
+
+        auto [policy, value] = predict(encodedState);
+        std::copy(policy.begin(), policy.begin() + actionSize, policies + static_cast<size_t>(i) * actionSize);
+        values[i] = value;
+    }
+}
\ No newline at end of file
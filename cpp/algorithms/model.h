@@ -0,0 +1,29 @@
+#ifndef MODEL_H
+#define MODEL_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Forward declaration for neural network model interface.
+// predict() is called from several threads at once when a search runs with
+// numThreads > 1.
+class Model {
+public:
+    virtual ~Model() = default;
+    virtual std::pair<std::vector<float>, float> predict(const std::vector<float>& encodedState) = 0;
+
+    // Evaluates batchSize encoded states stored back to back in states
+    // (stateSize floats each). Writes actionSize policy entries per state to
+    // policies and one value per state to values. The default calls
+    // predict() once per state; backends that can run a batch in one pass
+    // should override it.
+    virtual void predictBatch(const float* states, int batchSize, int stateSize,
+                              float* policies, int actionSize, float* values);
+
+    // Identifies the weights. Caches of evaluations are dropped when it
+    // changes, so a model whose weights can change must return a new value.
+    virtual uint64_t version() const { return 0; }
+};
+
+#endif // MODEL_H
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "nodeArena.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+template<typename T>
+NodeArena::Store<T>::Store()
+    : table(nullptr), numChunks(0), used(0), skipped(0) {
+}
+
+template<typename T>
+NodeArena::Store<T>::~Store() {
+    T** current = table.load();
+    for (int i = 0; i < numChunks.load(); ++i) {
+        delete current[i];
+    }
+}
+
+template<typename T>
+NodeIndex NodeArena::Store<T>::allocate(int count) {
+    if (count <= 0 || count > CHUNK_SIZE) {
+        throw std::invalid_argument("Invalid node block size");
+    }
+
+    NodeIndex current = used.load(std::memory_order_relaxed);
+    NodeIndex first;
+    do {
+        // Skip the tail of the current chunk if the block does not fit
+        first = current;
+        int offset = first & (CHUNK_SIZE - 1);
+        if (offset != 0 && offset + count > CHUNK_SIZE) {
+            first += CHUNK_SIZE - offset;
+        }
+    } while (!used.compare_exchange_weak(current, first + count, std::memory_order_relaxed));
+    if (first != current) {
+        skipped.fetch_add(first - current, std::memory_order_relaxed);
+    }
+
+    ensureChunk(first >> CHUNK_BITS);
+    return first;
+}
+
+template<typename T>
+void NodeArena::Store<T>::ensureChunk(int chunkIdx) {
+    if (chunkIdx < numChunks.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (chunkIdx >= MAX_CHUNKS) {
+        throw std::length_error("NodeArena capacity exceeded");
+    }
+
+    std::lock_guard<std::mutex> lock(growMutex);
+    int created = numChunks.load(std::memory_order_relaxed);
+    int capacity = tables.empty() ? 0 : static_cast<int>(tables.back().size());
+    if (chunkIdx >= capacity) {
+        int grown = std::max(capacity * 2, 16);
+        while (grown <= chunkIdx) {
+            grown *= 2;
+        }
+        std::vector<T*> larger(grown < MAX_CHUNKS ? grown : MAX_CHUNKS, nullptr);
+        if (!tables.empty()) {
+            std::copy(tables.back().begin(), tables.back().begin() + created, larger.begin());
+        }
+        tables.push_back(std::move(larger));
+        table.store(tables.back().data(), std::memory_order_release);
+    }
+
+    T** current = table.load(std::memory_order_relaxed);
+    while (created <= chunkIdx) {
+        current[created] = new T();
+        numChunks.store(++created, std::memory_order_release);
+    }
+}
+
+template<typename T>
+void NodeArena::Store<T>::swap(Store& other) {
+    T** tableHere = table.load();
+    table.store(other.table.load());
+    other.table.store(tableHere);
+    tables.swap(other.tables);
+
+    int chunksHere = numChunks.load();
+    numChunks.store(other.numChunks.load());
+    other.numChunks.store(chunksHere);
+
+    NodeIndex usedHere = used.load();
+    used.store(other.used.load());
+    other.used.store(usedHere);
+
+    NodeIndex skippedHere = skipped.load();
+    skipped.store(other.skipped.load());
+    other.skipped.store(skippedHere);
+}
+
+template<typename T>
+std::size_t NodeArena::Store<T>::bytes() const {
+    std::size_t tableBytes = 0;
+    for (const std::vector<T*>& old : tables) {
+        tableBytes += old.size() * sizeof(T*);
+    }
+    return static_cast<std::size_t>(numChunks.load(std::memory_order_relaxed)) * sizeof(T) + tableBytes;
+}
+
+NodeArena::NodeArena() : freeSlotCount(0), freeNodeCount(0) {
+}
+
+NodeArena::~NodeArena() = default;
+
+NodeIndex NodeArena::allocate(int count) {
+    if (freeSlotCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(freeMutex);
+        if (count > 0 && count < static_cast<int>(freeBlocks.size()) && !freeBlocks[count].empty()) {
+            NodeIndex first = freeBlocks[count].back();
+            freeBlocks[count].pop_back();
+            freeSlotCount.fetch_sub(count, std::memory_order_relaxed);
+            return first;
+        }
+    }
+    return slots.allocate(count);
+}
+
+MCTSNode* NodeArena::allocateNode() {
+    if (freeNodeCount.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(freeMutex);
+        if (!freeNodes.empty()) {
+            MCTSNode* node = freeNodes.back();
+            freeNodes.pop_back();
+            freeNodeCount.fetch_sub(1, std::memory_order_relaxed);
+            return node;
+        }
+    }
+    NodeIndex index = nodes.allocate(1);
+    return &nodes[index >> CHUNK_BITS].nodes[offset(index)];
+}
+
+void NodeArena::release(NodeIndex first, int count) {
+    std::lock_guard<std::mutex> lock(freeMutex);
+    if (count >= static_cast<int>(freeBlocks.size())) {
+        freeBlocks.resize(count + 1);
+    }
+    freeBlocks[count].push_back(first);
+    freeSlotCount.fetch_add(count, std::memory_order_relaxed);
+}
+
+void NodeArena::releaseNode(MCTSNode* node) {
+    std::lock_guard<std::mutex> lock(freeMutex);
+    freeNodes.push_back(node);
+    freeNodeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NodeArena::reset() {
+    slots.used.store(0, std::memory_order_relaxed);
+    slots.skipped.store(0, std::memory_order_relaxed);
+    nodes.used.store(0, std::memory_order_relaxed);
+    nodes.skipped.store(0, std::memory_order_relaxed);
+    for (std::vector<NodeIndex>& blocks : freeBlocks) {
+        blocks.clear();
+    }
+    freeNodes.clear();
+    freeSlotCount.store(0, std::memory_order_relaxed);
+    freeNodeCount.store(0, std::memory_order_relaxed);
+}
+
+void NodeArena::swap(NodeArena& other) {
+    slots.swap(other.slots);
+    nodes.swap(other.nodes);
+    freeBlocks.swap(other.freeBlocks);
+    freeNodes.swap(other.freeNodes);
+
+    std::size_t slotsHere = freeSlotCount.load();
+    freeSlotCount.store(other.freeSlotCount.load());
+    other.freeSlotCount.store(slotsHere);
+
+    std::size_t nodesHere = freeNodeCount.load();
+    freeNodeCount.store(other.freeNodeCount.load());
+    other.freeNodeCount.store(nodesHere);
+}
+
+std::size_t NodeArena::size() const {
+    return static_cast<std::size_t>(slots.used.load(std::memory_order_relaxed) -
+                                    slots.skipped.load(std::memory_order_relaxed)) -
+           freeSlotCount.load(std::memory_order_relaxed);
+}
+
+std::size_t NodeArena::builtNodes() const {
+    return static_cast<std::size_t>(nodes.used.load(std::memory_order_relaxed)) -
+           freeNodeCount.load(std::memory_order_relaxed);
+}
+
+std::size_t NodeArena::liveBytes() const {
+    return size() * (sizeof(Chunk) / CHUNK_SIZE) + builtNodes() * sizeof(MCTSNode);
+}
+
+std::size_t NodeArena::nodeBytes() {
+    return sizeof(Chunk) / CHUNK_SIZE + sizeof(MCTSNode);
+}
+
+std::size_t NodeArena::bytes() const {
+    return slots.bytes() + nodes.bytes();
+}
\ No newline at end of file
@@ -0,0 +1,220 @@
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include "../games/GameEnv.h"
+#include "puct.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Nodes refer to each other by index into their arena rather than by pointer,
+// so a whole tree can be dropped or relocated without touching every node.
+using NodeIndex = int32_t;
+const NodeIndex NO_NODE = -1;
+
+// Expansion protocol for shared trees: exactly one thread moves a leaf to
+// EXPANDING, writes its children and then publishes EXPANDED with release
+// semantics. Readers that observe EXPANDED see the children fully written.
+enum ExpansionState : int8_t {
+    LEAF = 0,
+    EXPANDING = 1,
+    EXPANDED = 2
+};
+
+// Structural per-node data. The statistics that PUCT selection reads for every
+// child (prior, visit count, value sum) and the action leading to the node
+// live in separate arrays in the arena, so a child can exist as just those
+// (an edge) until a search first descends into it.
+struct MCTSNode {
+    GameState state;
+    NodeIndex parent;
+    NodeIndex firstChild;   // children occupy [firstChild, firstChild + numChildren)
+    int numChildren;
+    int player;
+    float reward;
+};
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int) && std::atomic<int>::is_always_lock_free,
+              "visit counters are read as plain ints by puctArgmax");
+static_assert(sizeof(std::atomic<float>) == sizeof(float) && std::atomic<float>::is_always_lock_free,
+              "value sums are read as plain floats by puctArgmax");
+
+inline void atomicAdd(std::atomic<float>& target, float delta) {
+    float current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+    }
+}
+
+// Bump allocator for tree nodes. Memory is carved out of fixed-size chunks that
+// are kept across reset(), so after warm-up a search allocates nothing and
+// releasing a tree is constant time. A child block never straddles two chunks,
+// so the statistics of a node's children are contiguous in each array.
+//
+// A slot (NodeIndex) holds the action and statistics of a node and points to
+// its MCTSNode, which comes from a second set of chunks. The pointer is null
+// until the node is built, so a child nobody has selected yet costs a slot
+// but no MCTSNode.
+//
+// Allocation may happen from several threads at once. Chunks never move once
+// created, so indices and node pointers handed out stay valid while other
+// threads allocate.
+//
+// Slot blocks and nodes can also be released one subtree at a time, e.g. when
+// a tree over its memory limit collapses part of itself. Released memory
+// goes on free lists that allocation draws from before growing the arena;
+// until something is released, allocation does not touch them.
+class NodeArena {
+public:
+    static const int CHUNK_BITS = 12;
+    static const int CHUNK_SIZE = 1 << CHUNK_BITS;
+    static const int MAX_CHUNKS = 1 << 14;
+
+    NodeArena();
+    ~NodeArena();
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    // Reserves count consecutive slots (count <= CHUNK_SIZE) and returns the
+    // index of the first one. The slots are left uninitialized, their node
+    // pointers included.
+    NodeIndex allocate(int count);
+    // Reserves one MCTSNode, left uninitialized
+    MCTSNode* allocateNode();
+
+    // Returns a block from allocate(count), or a node, for reuse. No thread
+    // may still use it.
+    void release(NodeIndex first, int count);
+    void releaseNode(MCTSNode* node);
+
+    // Forgets every node and the free lists. Chunks stay allocated for the
+    // next tree.
+    // Not safe to call while other threads use the arena.
+    void reset();
+
+    // Exchanges contents with another arena. Not thread-safe.
+    void swap(NodeArena& other);
+
+    // The node of a slot, which must have been built
+    MCTSNode& operator[](NodeIndex index) {
+        return *chunk(index).node[offset(index)].load(std::memory_order_acquire);
+    }
+    const MCTSNode& operator[](NodeIndex index) const {
+        return *chunk(index).node[offset(index)].load(std::memory_order_acquire);
+    }
+    bool hasNode(NodeIndex index) const {
+        return chunk(index).node[offset(index)].load(std::memory_order_acquire) != nullptr;
+    }
+    // Points a slot at its node, or at null for a node built later. Stores
+    // with relaxed ordering for slots still private to the caller.
+    void setNode(NodeIndex index, MCTSNode* node) {
+        chunk(index).node[offset(index)].store(node, std::memory_order_relaxed);
+    }
+    // Publishes node as the node of a slot that has none. Returns false if
+    // another thread published one first.
+    bool publishNode(NodeIndex index, MCTSNode* node) {
+        MCTSNode* expected = nullptr;
+        return chunk(index).node[offset(index)].compare_exchange_strong(expected, node, std::memory_order_release,
+                                                                        std::memory_order_acquire);
+    }
+
+    int& action(NodeIndex index) { return chunk(index).action[offset(index)]; }
+    int action(NodeIndex index) const { return chunk(index).action[offset(index)]; }
+
+    float& prior(NodeIndex index) { return chunk(index).prior[offset(index)]; }
+    float prior(NodeIndex index) const { return chunk(index).prior[offset(index)]; }
+    std::atomic<int>& visits(NodeIndex index) { return chunk(index).visits[offset(index)]; }
+    int visits(NodeIndex index) const {
+        return chunk(index).visits[offset(index)].load(std::memory_order_relaxed);
+    }
+    std::atomic<float>& valueSum(NodeIndex index) { return chunk(index).valueSum[offset(index)]; }
+    float valueSum(NodeIndex index) const {
+        return chunk(index).valueSum[offset(index)].load(std::memory_order_relaxed);
+    }
+    std::atomic<int8_t>& expansion(NodeIndex index) { return chunk(index).expansion[offset(index)]; }
+    ExpansionState expansion(NodeIndex index) const {
+        return static_cast<ExpansionState>(
+            chunk(index).expansion[offset(index)].load(std::memory_order_acquire));
+    }
+
+    // Start of the statistics of a sibling block, padded for puctArgmax.
+    // Counters updated concurrently are read without synchronization here;
+    // selection tolerates slightly stale values.
+    const float* priors(NodeIndex first) const { return &chunk(first).prior[offset(first)]; }
+    const int* visitCounts(NodeIndex first) const {
+        return reinterpret_cast<const int*>(&chunk(first).visits[offset(first)]);
+    }
+    const float* valueSums(NodeIndex first) const {
+        return reinterpret_cast<const float*>(&chunk(first).valueSum[offset(first)]);
+    }
+
+    // Number of slots in use, i.e. handed out since the last reset and not
+    // released
+    std::size_t size() const;
+    // Number of MCTSNodes in use
+    std::size_t builtNodes() const;
+    // Memory the slots and MCTSNodes in use take
+    std::size_t liveBytes() const;
+    // Memory held by the arena, in use or not
+    std::size_t bytes() const;
+    // Memory taken by one slot and its node, i.e. the most one node costs
+    static std::size_t nodeBytes();
+
+private:
+    struct Chunk {
+        std::atomic<MCTSNode*> node[CHUNK_SIZE];   // null until built
+        int action[CHUNK_SIZE];
+        alignas(32) float prior[CHUNK_SIZE + PUCT_PAD];
+        alignas(32) std::atomic<int> visits[CHUNK_SIZE + PUCT_PAD];
+        alignas(32) std::atomic<float> valueSum[CHUNK_SIZE + PUCT_PAD];
+        std::atomic<int8_t> expansion[CHUNK_SIZE];
+    };
+
+    struct NodeChunk {
+        MCTSNode nodes[CHUNK_SIZE];
+    };
+
+    // Chunks of one kind and the bump pointer handing out their elements.
+    // The table of chunk pointers starts empty and doubles as chunks are
+    // added. Outgrown tables are kept until the store is destroyed, so a
+    // reader holding an older table still finds every chunk it can know of.
+    template<typename T>
+    struct Store {
+        Store();
+        ~Store();
+
+        NodeIndex allocate(int count);
+        void ensureChunk(int chunkIdx);
+        void swap(Store& other);
+        std::size_t bytes() const;
+
+        T& operator[](int chunkIdx) const { return *table.load(std::memory_order_acquire)[chunkIdx]; }
+
+        std::atomic<T**> table;
+        std::vector<std::vector<T*>> tables;   // every table so far, the current one last
+        std::atomic<int> numChunks;
+        std::atomic<NodeIndex> used;
+        std::atomic<NodeIndex> skipped;   // chunk tails passed over by allocate()
+        std::mutex growMutex;
+    };
+
+    static int offset(NodeIndex index) { return index & (CHUNK_SIZE - 1); }
+    Chunk& chunk(NodeIndex index) { return slots[index >> CHUNK_BITS]; }
+    const Chunk& chunk(NodeIndex index) const { return slots[index >> CHUNK_BITS]; }
+
+    Store<Chunk> slots;
+    Store<NodeChunk> nodes;
+
+    // Released slot blocks by size, and released nodes. The atomic counts
+    // let allocation skip the lock while the lists are empty.
+    std::mutex freeMutex;
+    std::vector<std::vector<NodeIndex>> freeBlocks;
+    std::vector<MCTSNode*> freeNodes;
+    std::atomic<std::size_t> freeSlotCount;
+    std::atomic<std::size_t> freeNodeCount;
+};
+
+#endif // NODE_ARENA_H
\ No newline at end of file
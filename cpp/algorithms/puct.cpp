@@ -0,0 +1,152 @@
+#include "puct.h"
+#include <cmath>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(ALPHA0_NO_SIMD)
+#define PUCT_X86 1
+#include <immintrin.h>
+#endif
+
+int puctArgmaxScalar(const float* prior, const int* visits, const float* valueSum,
+                     int n, float explorationWeight, float sqrtParentVisits) {
+    int best = 0;
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (int i = 0; i < n; ++i) {
+        float qValue = 0.0f;
+        if (visits[i] > 0) {
+            qValue = -valueSum[i] / visits[i];
+        }
+        float score = qValue + explorationWeight * prior[i] *
+                      (sqrtParentVisits / (1.0f + visits[i]));
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+namespace {
+
+#ifdef PUCT_X86
+
+__attribute__((target("avx2")))
+int puctArgmaxAVX2(const float* prior, const int* visits, const float* valueSum,
+                   int n, float explorationWeight, float sqrtParentVisits) {
+    const __m256 weight = _mm256_set1_ps(explorationWeight);
+    const __m256 sqrtN = _mm256_set1_ps(sqrtParentVisits);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 negInf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i zeroI = _mm256_setzero_si256();
+
+    int best = 0;
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (int base = 0; base < n; base += 8) {
+        __m256 p = _mm256_loadu_ps(prior + base);
+        __m256i visitsI = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(visits + base));
+        __m256 v = _mm256_cvtepi32_ps(visitsI);
+        __m256 w = _mm256_loadu_ps(valueSum + base);
+
+        // Q = -W / N for visited children, 0 otherwise
+        __m256 visited = _mm256_castsi256_ps(_mm256_cmpgt_epi32(visitsI, zeroI));
+        __m256 q = _mm256_and_ps(visited, _mm256_xor_ps(_mm256_div_ps(w, v), signBit));
+
+        __m256 u = _mm256_mul_ps(_mm256_mul_ps(weight, p),
+                                 _mm256_div_ps(sqrtN, _mm256_add_ps(one, v)));
+        __m256 score = _mm256_add_ps(q, u);
+
+        // Lanes past the end of the block never win
+        __m256 valid = _mm256_castsi256_ps(
+            _mm256_cmpgt_epi32(_mm256_set1_epi32(n - base), lanes));
+        score = _mm256_blendv_ps(negInf, score, valid);
+
+        __m256 m = _mm256_max_ps(score, _mm256_permute2f128_ps(score, score, 1));
+        m = _mm256_max_ps(m, _mm256_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm256_max_ps(m, _mm256_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+        float blockMax = _mm256_cvtss_f32(m);
+
+        if (blockMax > bestScore) {
+            int hits = _mm256_movemask_ps(_mm256_cmp_ps(score, m, _CMP_EQ_OQ));
+            bestScore = blockMax;
+            best = base + __builtin_ctz(static_cast<unsigned>(hits));
+        }
+    }
+    return best;
+}
+
+__attribute__((target("sse2")))
+int puctArgmaxSSE2(const float* prior, const int* visits, const float* valueSum,
+                   int n, float explorationWeight, float sqrtParentVisits) {
+    const __m128 weight = _mm_set1_ps(explorationWeight);
+    const __m128 sqrtN = _mm_set1_ps(sqrtParentVisits);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 negInf = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i zeroI = _mm_setzero_si128();
+
+    int best = 0;
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (int base = 0; base < n; base += 4) {
+        __m128 p = _mm_loadu_ps(prior + base);
+        __m128i visitsI = _mm_loadu_si128(reinterpret_cast<const __m128i*>(visits + base));
+        __m128 v = _mm_cvtepi32_ps(visitsI);
+        __m128 w = _mm_loadu_ps(valueSum + base);
+
+        __m128 visited = _mm_castsi128_ps(_mm_cmpgt_epi32(visitsI, zeroI));
+        __m128 q = _mm_and_ps(visited, _mm_xor_ps(_mm_div_ps(w, v), signBit));
+
+        __m128 u = _mm_mul_ps(_mm_mul_ps(weight, p), _mm_div_ps(sqrtN, _mm_add_ps(one, v)));
+        __m128 score = _mm_add_ps(q, u);
+
+        __m128 valid = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(n - base), lanes));
+        score = _mm_or_ps(_mm_and_ps(valid, score), _mm_andnot_ps(valid, negInf));
+
+        __m128 m = _mm_max_ps(score, _mm_shuffle_ps(score, score, _MM_SHUFFLE(1, 0, 3, 2)));
+        m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+        float blockMax = _mm_cvtss_f32(m);
+
+        if (blockMax > bestScore) {
+            int hits = _mm_movemask_ps(_mm_cmpeq_ps(score, m));
+            bestScore = blockMax;
+            best = base + __builtin_ctz(static_cast<unsigned>(hits));
+        }
+    }
+    return best;
+}
+
+#endif
+
+using PuctKernel = int (*)(const float*, const int*, const float*, int, float, float);
+
+struct KernelChoice {
+    PuctKernel kernel;
+    const char* name;
+};
+
+KernelChoice selectKernel() {
+#ifdef PUCT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {puctArgmaxAVX2, "avx2"};
+    }
+    return {puctArgmaxSSE2, "sse2"};
+#else
+    return {puctArgmaxScalar, "scalar"};
+#endif
+}
+
+const KernelChoice selected = selectKernel();
+
+}
+
+int puctArgmax(const float* prior, const int* visits, const float* valueSum,
+               int n, float explorationWeight, float sqrtParentVisits) {
+    return selected.kernel(prior, visits, valueSum, n, explorationWeight, sqrtParentVisits);
+}
+
+const char* puctKernelName() {
+    return selected.name;
+}
\ No newline at end of file
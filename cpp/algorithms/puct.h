@@ -0,0 +1,26 @@
+#ifndef PUCT_H
+#define PUCT_H
+
+// PUCT argmax over the statistics of one sibling block, stored as parallel
+// arrays. Child i scores
+//
+//     Q_i + explorationWeight * prior_i * (sqrtParentVisits / (1 + visits_i))
+//
+// with Q_i = -valueSum_i / visits_i (0 for unvisited children). Returns the
+// first index with the highest score, like std::max_element.
+//
+// The arrays must stay readable up to the next multiple of PUCT_PAD past n;
+// lanes past n are read but never selected.
+const int PUCT_PAD = 8;
+
+int puctArgmax(const float* prior, const int* visits, const float* valueSum,
+               int n, float explorationWeight, float sqrtParentVisits);
+
+// Portable reference implementation, also used where no SIMD path applies
+int puctArgmaxScalar(const float* prior, const int* visits, const float* valueSum,
+                     int n, float explorationWeight, float sqrtParentVisits);
+
+// Name of the kernel puctArgmax dispatches to on this machine
+const char* puctKernelName();
+
+#endif // PUCT_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "searchStats.h"
+#include <algorithm>
+
+void SearchStats::merge(const SearchStats& other) {
+    searches += other.searches;
+    simulations += other.simulations;
+    seconds += other.seconds;
+    nodesAllocated += other.nodesAllocated;
+    treeNodes = std::max(treeNodes, other.treeNodes);
+    liveBytes = std::max(liveBytes, other.liveBytes);
+    treeBytes = std::max(treeBytes, other.treeBytes);
+    reusedTrees += other.reusedTrees;
+    reusedNodes += other.reusedNodes;
+    decidedStops += other.decidedStops;
+    ponderSimulations += other.ponderSimulations;
+    collapsedSubtrees += other.collapsedSubtrees;
+    collapsedNodes += other.collapsedNodes;
+    memoryStops += other.memoryStops;
+
+    selectionSeconds += other.selectionSeconds;
+    expansionSeconds += other.expansionSeconds;
+    evaluationSeconds += other.evaluationSeconds;
+    backpropagationSeconds += other.backpropagationSeconds;
+    modelCalls += other.modelCalls;
+    modelEvaluations += other.modelEvaluations;
+    cacheHits += other.cacheHits;
+    terminalLeaves += other.terminalLeaves;
+    collisions += other.collisions;
+    maxDepth = std::max(maxDepth, other.maxDepth);
+}
+
+void SearchStats::writeJson(std::ostream& out) const {
+    out << "{\"profiled\": " << (SEARCH_PROFILING ? "true" : "false")
+        << ", \"searches\": " << searches
+        << ", \"simulations\": " << simulations
+        << ", \"seconds\": " << seconds
+        << ", \"nodes_allocated\": " << nodesAllocated
+        << ", \"tree_nodes\": " << treeNodes
+        << ", \"live_bytes\": " << liveBytes
+        << ", \"tree_bytes\": " << treeBytes
+        << ", \"reused_trees\": " << reusedTrees
+        << ", \"reused_nodes\": " << reusedNodes
+        << ", \"reuse_rate\": " << reuseRate()
+        << ", \"decided_stops\": " << decidedStops
+        << ", \"ponder_simulations\": " << ponderSimulations
+        << ", \"collapsed_subtrees\": " << collapsedSubtrees
+        << ", \"collapsed_nodes\": " << collapsedNodes
+        << ", \"memory_stops\": " << memoryStops;
+    if (SEARCH_PROFILING) {
+        out << ", \"selection_seconds\": " << selectionSeconds
+            << ", \"expansion_seconds\": " << expansionSeconds
+            << ", \"evaluation_seconds\": " << evaluationSeconds
+            << ", \"backpropagation_seconds\": " << backpropagationSeconds
+            << ", \"model_calls\": " << modelCalls
+            << ", \"model_evaluations\": " << modelEvaluations
+            << ", \"cache_hits\": " << cacheHits
+            << ", \"terminal_leaves\": " << terminalLeaves
+            << ", \"collisions\": " << collisions
+            << ", \"max_depth\": " << maxDepth;
+    }
+    out << "}";
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <chrono>
+#include <ostream>
+
+// Per-phase timing and per-simulation counters are compiled in only when
+// MCTS_PROFILE is defined (make PROFILE=1, cmake -DMCTS_PROFILE=ON).
+// Without it those fields stay zero and the hot path does no extra work.
+#ifdef MCTS_PROFILE
+const bool SEARCH_PROFILING = true;
+#else
+const bool SEARCH_PROFILING = false;
+#endif
+
+// What one or more searches did. A search fills a fresh instance; merge()
+// adds up the stats of many, e.g. every move of a self-play run.
+struct SearchStats {
+    // Always filled, at O(1) cost per search
+    long long searches = 0;
+    long long simulations = 0;
+    double seconds = 0.0;
+    long long nodesAllocated = 0;  // nodes added to the tree
+    long long treeNodes = 0;       // live tree nodes after the search, largest over merged searches
+    long long liveBytes = 0;       // memory those nodes take, likewise
+    long long treeBytes = 0;       // arena memory held then, likewise
+    // MCTS2: searches that continued under the previous search's tree, and
+    // the nodes they kept from it
+    long long reusedTrees = 0;
+    long long reusedNodes = 0;
+    // Searches ended by SearchLimits::stopWhenDecided
+    long long decidedStops = 0;
+    // MCTS2: simulations run by pondering since the previous search
+    long long ponderSimulations = 0;
+    // MCTS2: subtrees collapsed to stay under the memory limit, and the
+    // nodes that released
+    long long collapsedSubtrees = 0;
+    long long collapsedNodes = 0;
+    // MCTS2: searches cut short because even a fully collapsed tree did not
+    // fit the memory limit
+    long long memoryStops = 0;
+
+    // With MCTS_PROFILE only
+    double selectionSeconds = 0.0;
+    double expansionSeconds = 0.0;        // policy masking, move() and flipBoard() for new children
+    double evaluationSeconds = 0.0;       // encoding and model calls, or waiting for evaluate()
+    double backpropagationSeconds = 0.0;
+    long long modelCalls = 0;
+    long long modelEvaluations = 0;       // leaves evaluated by the model
+    long long cacheHits = 0;              // leaves expanded from a cached evaluation
+    long long terminalLeaves = 0;
+    long long collisions = 0;             // selections abandoned on a leaf being expanded
+    int maxDepth = 0;
+
+    double reuseRate() const { return searches > 0 ? static_cast<double>(reusedTrees) / searches : 0.0; }
+
+    void merge(const SearchStats& other);
+
+    // One JSON object on a single line
+    void writeJson(std::ostream& out) const;
+};
+
+// Adds the time between construction and destruction to seconds when
+// profiling; does nothing otherwise
+class PhaseTimer {
+public:
+#ifdef MCTS_PROFILE
+    explicit PhaseTimer(double& seconds) : seconds(seconds), begin(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() { seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); }
+
+private:
+    double& seconds;
+    std::chrono::steady_clock::time_point begin;
+#else
+    explicit PhaseTimer(double&) {}
+#endif
+};
+
+#endif // SEARCH_STATS_H
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "selfPlay.h"
+#include "mcts.h"
+#include "inferenceScheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int mostVisited(const std::vector<float>& probs) {
+    return static_cast<int>(std::max_element(probs.begin(), probs.end()) - probs.begin());
+}
+
+int sampleMove(const std::vector<float>& probs, float temperature, std::mt19937_64& rng) {
+    // Relative to the largest prob, so the most visited move keeps weight 1
+    // and small temperatures cannot underflow every weight to 0
+    double maxProb = probs[mostVisited(probs)];
+    if (maxProb <= 0.0) {
+        return mostVisited(probs);
+    }
+    std::vector<double> weights(probs.size());
+    for (size_t i = 0; i < probs.size(); ++i) {
+        weights[i] = probs[i] > 0.0f ? std::pow(probs[i] / maxProb, 1.0 / temperature) : 0.0;
+    }
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+    return pick(rng);
+}
+
+// Games handed out to workers and the totals they report back
+struct SelfPlayRun {
+    Game<int>* game;
+    const SelfPlayConfig& config;
+    SampleWriter* writer;
+    std::atomic<int> nextGame;
+    std::mutex statsMutex;
+    SelfPlayStats stats;
+
+    SelfPlayRun(Game<int>* game, const SelfPlayConfig& config, SampleWriter* writer)
+        : game(game), config(config), writer(writer), nextGame(0) {
+    }
+
+    // Index of a game nobody has played yet, or -1
+    int claimGame() {
+        int index = nextGame.fetch_add(1, std::memory_order_relaxed);
+        return index < config.numGames ? index : -1;
+    }
+
+    void finishGame(const std::vector<float>& records, int plies, float firstPlayerOutcome,
+                    const SearchStats& search) {
+        if (writer != nullptr) {
+            writer->append(records.data(), plies);
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.games++;
+        stats.positions += plies;
+        stats.search.merge(search);
+        if (firstPlayerOutcome > 0.0f) {
+            stats.wins++;
+        } else if (firstPlayerOutcome < 0.0f) {
+            stats.losses++;
+        } else {
+            stats.draws++;
+        }
+    }
+};
+
+// One game of self-play driven one leaf at a time: advance() runs its search
+// until a leaf needs the model, and resume() continues once the evaluation
+// is in. Between games it claims the next one from run.
+class GameTask {
+public:
+    GameTask(SelfPlayRun& run, Model* model, EvaluationCache* cache)
+        : run(run), game(run.game), mcts(game, model, run.config.numSimulations, run.config.explorationWeight),
+          index(-1), plies(0) {
+        if (cache != nullptr) {
+            mcts.setEvaluationCache(cache);
+        }
+    }
+
+    // Plays until a leaf needs evaluating and returns it, or null once no
+    // games are left
+    const GameState* advance() {
+        if (index < 0 && !startGame()) {
+            return nullptr;
+        }
+        for (;;) {
+            if (const GameState* leaf = mcts.nextLeaf()) {
+                return leaf;
+            }
+            if (!playMove() && !startGame()) {
+                return nullptr;
+            }
+        }
+    }
+
+    void resume(const float* policy, float value) {
+        mcts.evaluate(policy, value);
+    }
+
+private:
+    bool startGame() {
+        index = run.claimGame();
+        if (index < 0) {
+            return false;
+        }
+        rng.seed(mixSeed(run.config.seed, static_cast<uint64_t>(index)));
+        mcts.setRootNoise(run.config.dirichletAlpha, run.config.noiseFraction, rng());
+        records.clear();
+        searchStats = SearchStats();
+        plies = 0;
+        state = game->start();
+        mcts.beginSearch(state);
+        return true;
+    }
+
+    // Records the finished search and plays its move. Returns false once
+    // the game is over.
+    bool playMove() {
+        const SelfPlayConfig& config = run.config;
+        SearchStats moveStats;
+        std::vector<float> probs = mcts.searchResult(&moveStats);
+        searchStats.merge(moveStats);
+        std::vector<float> encoded = game->encodeState(state);
+        records.insert(records.end(), encoded.begin(), encoded.end());
+        records.insert(records.end(), probs.begin(), probs.end());
+        records.push_back(0.0f);
+
+        bool explore = config.temperature > 0.0f &&
+                       (config.temperatureMoves < 0 || plies < config.temperatureMoves);
+        int action = explore ? sampleMove(probs, config.temperature, rng) : mostVisited(probs);
+
+        auto [next, reward] = game->move(state, action);
+        plies++;
+        if (!next.isTerminal) {
+            state = game->flipBoard(next);
+            mcts.beginSearch(state);
+            return true;
+        }
+
+        // reward is for the player who made the last move; players alternate
+        int stateSize = game->stateSpaceSize();
+        int recordFloats = stateSize + game->actionSpaceSize() + 1;
+        float opponentReward = game->getOpponentReward(reward);
+        for (int ply = 0; ply < plies; ++ply) {
+            bool lastMover = (plies - 1 - ply) % 2 == 0;
+            records[static_cast<size_t>(ply + 1) * recordFloats - 1] = lastMover ? reward : opponentReward;
+        }
+        run.finishGame(records, plies, (plies % 2 == 1) ? reward : opponentReward, searchStats);
+        index = -1;
+        return false;
+    }
+
+    SelfPlayRun& run;
+    Game<int>* game;
+    MCTS mcts;
+    std::mt19937_64 rng;
+    int index;
+    int plies;
+    GameState state;
+    std::vector<float> records;
+    SearchStats searchStats;
+};
+
+// Plays games one after another, calling the model directly
+void playDirect(SelfPlayRun& run, Model* model, EvaluationCache* cache) {
+    GameTask task(run, model, cache);
+    while (const GameState* leaf = task.advance()) {
+        auto [policy, value] = model->predict(run.game->encodeState(*leaf));
+        task.resume(policy.data(), value);
+    }
+}
+
+// Interleaves numTasks games, sending every leaf to the scheduler and
+// resuming each game when its evaluation comes back
+void playScheduled(SelfPlayRun& run, Model* model, EvaluationCache* cache, InferenceScheduler& scheduler,
+                   int numTasks) {
+    std::vector<std::unique_ptr<GameTask>> tasks;
+    std::vector<InferenceRequest> requests(numTasks);
+    InferenceScheduler::Client client(scheduler);
+    int active = 0;
+
+    auto advance = [&](int t) {
+        const GameState* leaf = tasks[t]->advance();
+        if (leaf == nullptr) {
+            active--;
+            return;
+        }
+        requests[t].state = run.game->encodeState(*leaf);
+        scheduler.submit(client, &requests[t]);
+    };
+
+    for (int t = 0; t < numTasks; ++t) {
+        tasks.push_back(std::make_unique<GameTask>(run, model, cache));
+        requests[t].tag = t;
+        active++;
+        advance(t);
+    }
+
+    std::vector<int> ready;
+    while (active > 0) {
+        ready.clear();
+        client.waitReady(ready);
+        for (int t : ready) {
+            tasks[t]->resume(requests[t].policy.data(), requests[t].value);
+            advance(t);
+        }
+    }
+}
+
+}
+
+SelfPlayStats runSelfPlay(Game<int>* game, Model* model, const SelfPlayConfig& config,
+                          SampleWriter* writer, EvaluationCache* cache) {
+    if (config.numSimulations <= 0) {
+        throw std::invalid_argument("Self-play needs at least one simulation per move");
+    }
+    if (writer != nullptr && writer->recordFloats() != game->stateSpaceSize() + game->actionSpaceSize() + 1) {
+        throw std::invalid_argument("Sample writer does not match the game's state and action sizes");
+    }
+
+    SelfPlayRun run(game, config, writer);
+    int numThreads = std::max(1, std::min(config.numThreads, config.numGames));
+    std::unique_ptr<InferenceScheduler> scheduler;
+    if (config.concurrentGames > 0) {
+        scheduler = std::make_unique<InferenceScheduler>(model, game->stateSpaceSize(), game->actionSpaceSize(),
+                                                         config.maxBatch,
+                                                         std::chrono::microseconds(config.maxWaitMicros));
+        numThreads = std::min(numThreads, config.concurrentGames);
+    }
+
+    auto worker = [&](int thread) {
+        if (scheduler) {
+            // Spread the concurrent games evenly over the threads
+            int numTasks = config.concurrentGames / numThreads + (thread < config.concurrentGames % numThreads);
+            playScheduled(run, model, cache, *scheduler, numTasks);
+        } else {
+            playDirect(run, model, cache);
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> helpers;
+    helpers.reserve(numThreads - 1);
+    for (int t = 1; t < numThreads; ++t) {
+        helpers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    run.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (scheduler) {
+        run.stats.inference = scheduler->stats();
+    }
+    if (writer != nullptr) {
+        writer->flush();
+    }
+    return run.stats;
+}
\ No newline at end of file
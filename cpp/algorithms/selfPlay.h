@@ -0,0 +1,60 @@
+#ifndef SELF_PLAY_H
+#define SELF_PLAY_H
+
+#include "../games/GameEnv.h"
+#include "../data/sampleWriter.h"
+#include "model.h"
+#include "evaluationCache.h"
+#include "inferenceScheduler.h"
+#include "searchStats.h"
+#include <cstdint>
+
+struct SelfPlayConfig {
+    int numGames = 100;
+    int numSimulations = 800;
+    int numThreads = 1;
+    float explorationWeight = 1.0f;
+    // Moves are sampled from visit counts raised to 1 / temperature. After
+    // temperatureMoves plies (never if negative) or at temperature 0 the
+    // most visited move is played instead.
+    float temperature = 1.0f;
+    int temperatureMoves = -1;
+    float dirichletAlpha = 1.0f;
+    float noiseFraction = 0.25f; // 0 disables root noise
+    uint64_t seed = 0;
+    // With concurrentGames > 0 that many games are in flight at once,
+    // spread over the threads, and their leaves share model calls of up to
+    // maxBatch states, each waiting at most maxWaitMicros for the batch to
+    // fill. Otherwise every thread plays one game and calls the model itself.
+    int concurrentGames = 0;
+    int maxBatch = 256;
+    int maxWaitMicros = 1000;
+};
+
+struct SelfPlayStats {
+    int games = 0;
+    long long positions = 0;
+    double seconds = 0.0;
+    // Results for the player who moved first
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+    // Shared model calls, with concurrentGames only
+    InferenceStats inference;
+    // Every search of every game
+    SearchStats search;
+
+    double gamesPerSecond() const { return seconds > 0.0 ? games / seconds : 0.0; }
+    double positionsPerSecond() const { return seconds > 0.0 ? positions / seconds : 0.0; }
+};
+
+// Plays config.numGames games of game against itself, numThreads at a
+// time, and appends one record per position to writer (if not null). Game
+// i draws all its randomness from a generator seeded with config.seed and
+// i, so the games do not depend on the number of threads; only the order
+// in which they are written does. game and model
+// are shared by every thread; cache, if given, by every search.
+SelfPlayStats runSelfPlay(Game<int>* game, Model* model, const SelfPlayConfig& config,
+                          SampleWriter* writer, EvaluationCache* cache = nullptr);
+
+#endif // SELF_PLAY_H
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "transpositionTable.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+TranspositionTable::TranspositionTable(std::size_t bytes, int actionSize)
+    : actionSize(actionSize), numBuckets(1), generation(1),
+      lookups(0), hits(0), stores(0), replacements(0) {
+    if (actionSize <= 0) {
+        throw std::invalid_argument("Invalid action size");
+    }
+
+    // Largest power of two that fits the budget, so a bucket is hash & mask
+    std::size_t bucketBytes = sizeof(Bucket) + WAYS * actionSize * sizeof(float);
+    while (numBuckets * 2 * bucketBytes <= bytes) {
+        numBuckets *= 2;
+    }
+
+    buckets.reset(new Bucket[numBuckets]);
+    policies.reset(new float[numBuckets * WAYS * actionSize]());
+    for (std::size_t i = 0; i < numBuckets; ++i) {
+        buckets[i].lock.store(0, std::memory_order_relaxed);
+        buckets[i].victim = 0;
+        for (Entry& entry : buckets[i].entries) {
+            entry.key = 0;
+            entry.generation = 0;
+            entry.value = 0.0f;
+        }
+    }
+}
+
+void TranspositionTable::lockBucket(Bucket& bucket) {
+    while (bucket.lock.exchange(1, std::memory_order_acquire)) {
+        while (bucket.lock.load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void TranspositionTable::unlockBucket(Bucket& bucket) {
+    bucket.lock.store(0, std::memory_order_release);
+}
+
+bool TranspositionTable::lookup(uint64_t hash, float* policy, float& value) {
+    lookups.fetch_add(1, std::memory_order_relaxed);
+
+    std::size_t bucketIdx = hash & (numBuckets - 1);
+    Bucket& bucket = buckets[bucketIdx];
+    lockBucket(bucket);
+    for (int way = 0; way < WAYS; ++way) {
+        const Entry& entry = bucket.entries[way];
+        if (entry.key == hash && entry.generation == generation) {
+            const float* cached = policyOf(bucketIdx, way);
+            std::copy(cached, cached + actionSize, policy);
+            value = entry.value;
+            bucket.victim = static_cast<uint8_t>(1 - way);
+            unlockBucket(bucket);
+
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    unlockBucket(bucket);
+    return false;
+}
+
+void TranspositionTable::store(uint64_t hash, const float* policy, float value) {
+    stores.fetch_add(1, std::memory_order_relaxed);
+
+    std::size_t bucketIdx = hash & (numBuckets - 1);
+    Bucket& bucket = buckets[bucketIdx];
+    lockBucket(bucket);
+
+    // Same position first, then a stale entry, then the least recently used
+    int target = -1;
+    for (int way = 0; way < WAYS && target < 0; ++way) {
+        if (bucket.entries[way].key == hash) target = way;
+    }
+    for (int way = 0; way < WAYS && target < 0; ++way) {
+        if (bucket.entries[way].generation != generation) target = way;
+    }
+    if (target < 0) {
+        target = bucket.victim;
+        replacements.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Entry& entry = bucket.entries[target];
+    entry.key = hash;
+    entry.generation = generation;
+    entry.value = value;
+    std::copy(policy, policy + actionSize, policyOf(bucketIdx, target));
+    bucket.victim = static_cast<uint8_t>(1 - target);
+
+    unlockBucket(bucket);
+}
+
+void TranspositionTable::newSearch() {
+    // Generation 0 marks never-used entries, so skip it on wrap-around
+    if (++generation == 0) {
+        generation = 1;
+    }
+}
+
+TranspositionStats TranspositionTable::stats() const {
+    TranspositionStats result;
+    result.lookups = lookups.load(std::memory_order_relaxed);
+    result.hits = hits.load(std::memory_order_relaxed);
+    result.stores = stores.load(std::memory_order_relaxed);
+    result.replacements = replacements.load(std::memory_order_relaxed);
+    return result;
+}
+
+void TranspositionTable::resetStats() {
+    lookups.store(0, std::memory_order_relaxed);
+    hits.store(0, std::memory_order_relaxed);
+    stores.store(0, std::memory_order_relaxed);
+    replacements.store(0, std::memory_order_relaxed);
+}
+
+std::size_t TranspositionTable::bytes() const {
+    return numBuckets * (sizeof(Bucket) + WAYS * actionSize * sizeof(float));
+}
\ No newline at end of file
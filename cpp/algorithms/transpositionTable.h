@@ -0,0 +1,83 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct TranspositionStats {
+    uint64_t lookups;
+    uint64_t hits;          // model evaluations saved
+    uint64_t stores;
+    uint64_t replacements;  // stores that evicted a live entry of another position
+
+    double hitRate() const { return lookups ? static_cast<double>(hits) / lookups : 0.0; }
+};
+
+// Fixed-size cache of network evaluations (masked policy and value) keyed by
+// Zobrist hash, so a position reached through several move orders is
+// evaluated once per search.
+//
+// The table is an array of two-way buckets sized from a memory budget and
+// never grows. A store replaces a matching or stale entry first and
+// otherwise the less recently used of the two. Each bucket has its own
+// spinlock, so search threads only contend when they touch the same bucket.
+class TranspositionTable {
+public:
+    static const int WAYS = 2;
+
+    // Uses at most bytes of memory (at least one bucket)
+    TranspositionTable(std::size_t bytes, int actionSize);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Copies the cached evaluation of hash into policy (actionSize floats)
+    // and value. Returns false if the position is not cached.
+    bool lookup(uint64_t hash, float* policy, float& value);
+    void store(uint64_t hash, const float* policy, float value);
+
+    // Makes every entry stale in O(1). Called at the start of each search,
+    // while no other thread uses the table.
+    void newSearch();
+
+    TranspositionStats stats() const;
+    void resetStats();
+
+    std::size_t capacity() const { return numBuckets * WAYS; }
+    std::size_t bytes() const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t generation;   // entries of older generations are stale
+        float value;
+    };
+
+    struct Bucket {
+        std::atomic<uint8_t> lock;
+        uint8_t victim;        // way to replace when both are live
+        Entry entries[WAYS];
+    };
+
+    void lockBucket(Bucket& bucket);
+    void unlockBucket(Bucket& bucket);
+    float* policyOf(std::size_t bucketIdx, int way) {
+        return policies.get() + (bucketIdx * WAYS + way) * actionSize;
+    }
+
+    int actionSize;
+    std::size_t numBuckets;
+    std::unique_ptr<Bucket[]> buckets;
+    std::unique_ptr<float[]> policies;
+    uint32_t generation;
+
+    std::atomic<uint64_t> lookups;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> stores;
+    std::atomic<uint64_t> replacements;
+};
+
+#endif // TRANSPOSITION_TABLE_H
\ No newline at end of file
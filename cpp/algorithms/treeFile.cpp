@@ -0,0 +1,83 @@
+#include "treeFile.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "TreeFile reads and writes little-endian tree files directly"
+#endif
+
+namespace {
+
+const char TREE_MAGIC[8] = {'A', '0', 'M', 'C', 'T', 'R', 'E', 'E'};
+
+}
+
+namespace TreeFile {
+
+void write(const std::string& path, TreeFileHeader header, const std::vector<TreeFileRecord>& records) {
+    std::memcpy(header.magic, TREE_MAGIC, sizeof(TREE_MAGIC));
+    header.version = VERSION;
+    header.numRecords = records.size();
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("Cannot open tree file " + path);
+    }
+    bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   std::fwrite(records.data(), sizeof(TreeFileRecord), records.size(), file) == records.size();
+    if (std::fclose(file) != 0 || !written) {
+        throw std::runtime_error("Cannot write tree file " + path);
+    }
+}
+
+TreeFileHeader read(const std::string& path, std::vector<TreeFileRecord>& records) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        throw std::runtime_error("Cannot open tree file " + path);
+    }
+
+    TreeFileHeader header;
+    try {
+        if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+            std::memcmp(header.magic, TREE_MAGIC, sizeof(TREE_MAGIC)) != 0) {
+            throw std::invalid_argument(path + " is not a tree file");
+        }
+        if (header.version != VERSION) {
+            throw std::invalid_argument(path + " has unsupported tree format version " +
+                                        std::to_string(header.version));
+        }
+        if (header.numRecords == 0 || header.numRecords > (uint64_t(1) << 31)) {
+            throw std::invalid_argument("Invalid header in " + path);
+        }
+
+        // Checked before allocating, so a bad count cannot ask for gigabytes
+        long start = std::ftell(file);
+        if (start < 0 || std::fseek(file, 0, SEEK_END) != 0) {
+            throw std::runtime_error("Cannot read tree file " + path);
+        }
+        long end = std::ftell(file);
+        if (end < 0 || std::fseek(file, start, SEEK_SET) != 0) {
+            throw std::runtime_error("Cannot read tree file " + path);
+        }
+        uint64_t recordBytes = header.numRecords * sizeof(TreeFileRecord);
+        if (static_cast<uint64_t>(end - start) < recordBytes) {
+            throw std::invalid_argument("Truncated tree file " + path);
+        }
+        if (static_cast<uint64_t>(end - start) != recordBytes) {
+            throw std::invalid_argument("Invalid header in " + path);
+        }
+
+        records.resize(header.numRecords);
+        if (std::fread(records.data(), sizeof(TreeFileRecord), records.size(), file) != records.size()) {
+            throw std::invalid_argument("Truncated tree file " + path);
+        }
+    } catch (...) {
+        std::fclose(file);
+        throw;
+    }
+    std::fclose(file);
+    return header;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef TREE_FILE_H
+#define TREE_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Saved search tree, e.g. a deep opening tree shipped with an engine so the
+// first moves of a game start from a warm tree (BasicMCTSTree::save/load).
+//
+// Layout, all little-endian:
+//
+//     TreeFileHeader                            at offset 0
+//     TreeFileRecord[numRecords]                right after the header
+//
+// Records are the tree's nodes in breadth-first order, the root first. The
+// children of an expanded node are the next numChildren records not yet
+// claimed by an earlier node, in the order the node lists its actions. Only
+// the root's state is stored: every other state follows from its parent's
+// by the record's action, so the loader replays the moves instead.
+struct TreeFileHeader {
+    char magic[8];          // "A0MCTREE"
+    uint32_t version;
+    uint32_t actionSize;
+    uint32_t stateSize;
+    uint32_t boardBytes;    // GameState::CAPACITY
+    uint64_t numRecords;
+    uint64_t rootHash;
+    uint8_t rootBoard[24];
+    uint8_t rootTerminal;
+    uint8_t padding[7];
+};
+
+struct TreeFileRecord {
+    float prior;
+    int32_t visits;
+    float valueSum;
+    int32_t action;         // -1 for the root
+    uint16_t numChildren;   // 0 unless EXPANDED
+    uint8_t flags;          // TreeFile::Flags
+    uint8_t reserved;
+};
+
+static_assert(sizeof(TreeFileHeader) == 72, "tree file header is 72 bytes");
+static_assert(sizeof(TreeFileRecord) == 20, "tree file records are 20 bytes");
+
+namespace TreeFile {
+
+const uint32_t VERSION = 1;
+
+enum Flags : uint8_t {
+    BUILT = 1,      // the node has a state; unbuilt nodes are edges only
+    EXPANDED = 2    // the node's children follow; implies BUILT
+};
+
+// Writes header, with magic, version and numRecords filled in, and records
+// to path. Throws if the file cannot be written.
+void write(const std::string& path, TreeFileHeader header, const std::vector<TreeFileRecord>& records);
+
+// Reads a whole tree file into records and returns its header. Throws if
+// the file is missing, truncated or not a supported version.
+TreeFileHeader read(const std::string& path, std::vector<TreeFileRecord>& records);
+
+}
+
+#endif // TREE_FILE_H
\ No newline at end of file
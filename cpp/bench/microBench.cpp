@@ -0,0 +1,418 @@
+#include "../algorithms/mcts.h"
+#include "../algorithms/puct.h"
+#include "../models/dense.h"
+#include "../models/mlpModel.h"
+#include "../models/weightFile.h"
+#include "../games/ConnectFour/ConnectFour.h"
+#include "../games/TicTacToe/TicTacToe.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+// Microbenchmarks of the game and search hot paths, in the spirit of Google
+// Benchmark: every benchmark runs with growing iteration counts until one
+// run takes at least --min-time, and the time per iteration of that run is
+// reported. --json writes the results in Google Benchmark's JSON layout so
+// runs from different commits can be compared with the same tools.
+//
+//   microBench [--filter SUBSTRING] [--min-time SECONDS] [--json FILE] [--weights FILE]
+//
+// Without --weights the MLP benchmarks use a random 128x128 network of the
+// shape networks.py trains for ConnectFour.
+
+namespace {
+
+// Keeps the compiler from dropping a computed value
+template<typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Benchmark {
+    std::string name;
+    std::function<void(long long)> body;   // runs the given number of iterations
+    double itemsPerIteration;
+};
+
+struct Result {
+    std::string name;
+    long long iterations;
+    double realNs;
+    double cpuNs;
+    double itemsPerSecond;
+};
+
+Result run(const Benchmark& benchmark, double minTime) {
+    using clock = std::chrono::steady_clock;
+    long long iterations = 1;
+    for (;;) {
+        std::clock_t cpuStart = std::clock();
+        auto start = clock::now();
+        benchmark.body(iterations);
+        double seconds = std::chrono::duration<double>(clock::now() - start).count();
+        double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+        if (seconds >= minTime || iterations >= (1LL << 40)) {
+            return {benchmark.name, iterations, 1e9 * seconds / iterations, 1e9 * cpuSeconds / iterations,
+                    benchmark.itemsPerIteration * iterations / seconds};
+        }
+        // Aim 40% past minTime, growing at most tenfold per step
+        double scale = seconds > 0.0 ? 1.4 * minTime / seconds : 10.0;
+        iterations = static_cast<long long>(iterations * std::min(std::max(scale, 2.0), 10.0));
+    }
+}
+
+// Non-terminal positions from random games, with one valid action each
+struct Positions {
+    std::vector<GameState> states;
+    std::vector<int> actions;
+};
+
+Positions randomPositions(Game<int>& game, int count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    Positions positions;
+    GameState state = game.start();
+    while (static_cast<int>(positions.states.size()) < count) {
+        std::vector<int> actions = game.getValidActions(state);
+        int action = actions[rng() % actions.size()];
+        positions.states.push_back(state);
+        positions.actions.push_back(action);
+
+        GameState next = game.move(state, action).first;
+        state = next.isTerminal ? game.start() : game.flipBoard(next);
+    }
+    return positions;
+}
+
+// Writes a network of random weights in the layout of weightFile.h
+void writeRandomNetwork(const std::string& path, const std::vector<int>& sizes, uint64_t seed) {
+    const uint32_t alignment = 64;
+    auto alignUp = [](uint64_t n) { return (n + alignment - 1) / alignment * alignment; };
+    auto padded = [](int n) { return (n + DENSE_LANES - 1) / DENSE_LANES * DENSE_LANES; };
+
+    int numLayers = static_cast<int>(sizes.size()) - 1;
+    std::vector<WeightFileLayer> layers(numLayers);
+    uint64_t offset = alignUp(sizeof(WeightFileHeader) + numLayers * sizeof(WeightFileLayer));
+    for (int i = 0; i < numLayers; ++i) {
+        WeightFileLayer& layer = layers[i];
+        layer.in = static_cast<uint32_t>(i == 0 ? sizes[0] : padded(sizes[i]));
+        layer.out = static_cast<uint32_t>(sizes[i + 1]);
+        layer.outStride = static_cast<uint32_t>(padded(sizes[i + 1]));
+        layer.activation = i + 1 == numLayers ? WeightFile::NONE : WeightFile::RELU;
+        layer.weightsOffset = offset;
+        offset = alignUp(offset + sizeof(float) * layer.in * layer.outStride);
+        layer.biasOffset = offset;
+        offset = alignUp(offset + sizeof(float) * layer.outStride);
+    }
+
+    WeightFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "A0WEIGHT", 8);
+    header.version = WeightFile::VERSION;
+    header.numLayers = static_cast<uint32_t>(numLayers);
+    header.stateSize = static_cast<uint32_t>(sizes.front());
+    header.actionSize = static_cast<uint32_t>(sizes.back() - 1);
+    header.alignment = alignment;
+    header.fileSize = offset;
+
+    std::vector<unsigned char> bytes(offset, 0);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), layers.data(), layers.size() * sizeof(WeightFileLayer));
+
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> weight(-0.1f, 0.1f);
+    for (const WeightFileLayer& layer : layers) {
+        float* weights = reinterpret_cast<float*>(bytes.data() + layer.weightsOffset);
+        for (uint32_t row = 0; row < layer.in; ++row) {
+            for (uint32_t col = 0; col < layer.out; ++col) {
+                weights[row * layer.outStride + col] = weight(rng);
+            }
+        }
+        float* bias = reinterpret_cast<float*>(bytes.data() + layer.biasOffset);
+        for (uint32_t col = 0; col < layer.out; ++col) {
+            bias[col] = weight(rng);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+std::unique_ptr<MLPModel> loadNetwork(const std::string& weights, int stateSize, int actionSize) {
+    if (!weights.empty()) {
+        return std::make_unique<MLPModel>(weights);
+    }
+    char path[] = "/tmp/microBenchXXXXXX";
+    int fd = ::mkstemp(path);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create a temporary weight file");
+    }
+    ::close(fd);
+    writeRandomNetwork(path, {stateSize, 128, 128, actionSize + 1}, 42);
+    // The mapping keeps the weights alive after the file is gone
+    auto model = std::make_unique<MLPModel>(path);
+    std::remove(path);
+    return model;
+}
+
+template<typename G>
+void addGameBenchmarks(std::vector<Benchmark>& benchmarks, const std::string& name,
+                       std::function<bool(G&, const GameState&)> checkWinner) {
+    auto game = std::make_shared<G>();
+    auto positions = std::make_shared<Positions>(randomPositions(*game, 4096, 1));
+    const size_t mask = 4095;
+
+    benchmarks.push_back({name + "/move", [game, positions](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            size_t p = static_cast<size_t>(i) & mask;
+            keep(game->move(positions->states[p], positions->actions[p]));
+        }
+    }, 1.0});
+    benchmarks.push_back({name + "/flipBoard", [game, positions](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            keep(game->flipBoard(positions->states[static_cast<size_t>(i) & mask]));
+        }
+    }, 1.0});
+    benchmarks.push_back({name + "/getValidActions", [game, positions](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            keep(game->getValidActions(positions->states[static_cast<size_t>(i) & mask]).size());
+        }
+    }, 1.0});
+    benchmarks.push_back({name + "/encodeState", [game, positions](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            keep(game->encodeState(positions->states[static_cast<size_t>(i) & mask]).data()[0]);
+        }
+    }, 1.0});
+    benchmarks.push_back({name + "/checkWinner", [game, positions, checkWinner](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            keep(checkWinner(*game, positions->states[static_cast<size_t>(i) & mask]));
+        }
+    }, 1.0});
+}
+
+// Every expanded node of a ConnectFour tree grown with uniform priors
+std::shared_ptr<std::vector<NodeIndex>> growTree(MCTSTree& tree, Game<int>& game, int numSimulations) {
+    std::vector<float> uniform(game.actionSpaceSize(), 1.0f / game.actionSpaceSize());
+    tree.reset(game.start());
+    for (int i = 0; i < numSimulations; ++i) {
+        NodeIndex leaf = tree.root();
+        while (tree.isFullyExpanded(leaf) && !tree.node(leaf).state.isTerminal) {
+            leaf = tree.bestChild(leaf);
+        }
+        float value = 0.0f;
+        if (!tree.node(leaf).state.isTerminal) {
+            tree.expand(leaf, uniform.data());
+        } else {
+            value = tree.node(leaf).reward;
+        }
+        tree.backpropagate(leaf, value);
+    }
+
+    auto expanded = std::make_shared<std::vector<NodeIndex>>();
+    for (NodeIndex i = 0; i < static_cast<NodeIndex>(tree.size()); ++i) {
+        if (tree.built(i) && tree.node(i).numChildren > 0) {
+            expanded->push_back(i);
+        }
+    }
+    return expanded;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results, const char* executable) {
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+    out << std::setprecision(10);
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"executable\": \"" << jsonEscape(executable) << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\",\n"
+#else
+        << "    \"library_build_type\": \"debug\",\n"
+#endif
+        << "    \"puct_kernel\": \"" << puctKernelName() << "\",\n"
+        << "    \"dense_kernel\": \"" << denseKernelName() << "\"\n"
+        << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << (i ? "," : "") << "\n    {\n"
+            << "      \"name\": \"" << jsonEscape(r.name) << "\",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"iterations\": " << r.iterations << ",\n"
+            << "      \"real_time\": " << r.realNs << ",\n"
+            << "      \"cpu_time\": " << r.cpuNs << ",\n"
+            << "      \"time_unit\": \"ns\",\n"
+            << "      \"items_per_second\": " << r.itemsPerSecond << "\n"
+            << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double minTime = 0.2;
+    std::string jsonPath;
+    std::string weights;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--filter") {
+            filter = argv[i + 1];
+        } else if (flag == "--min-time") {
+            minTime = std::atof(argv[i + 1]);
+        } else if (flag == "--json") {
+            jsonPath = argv[i + 1];
+        } else if (flag == "--weights") {
+            weights = argv[i + 1];
+        } else {
+            std::cerr << "usage: microBench [--filter SUBSTRING] [--min-time SECONDS] [--json FILE] "
+                         "[--weights FILE]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Benchmark> benchmarks;
+    addGameBenchmarks<ConnectFour>(benchmarks, "ConnectFour", [](ConnectFour&, const GameState& state) {
+        return ConnectFour::checkWinner(state.board<ConnectFour::Board>().opponent);
+    });
+    addGameBenchmarks<TicTacToe>(benchmarks, "TicTacToe", [](TicTacToe& game, const GameState& state) {
+        return game.checkWinner(state.board<TicTacToe::Board>());
+    });
+
+    auto connectFour = std::make_shared<ConnectFour>();
+    int actionSize = connectFour->actionSpaceSize();
+    int stateSize = connectFour->stateSpaceSize();
+
+    auto expandTree = std::make_shared<MCTSTree>(connectFour.get());
+    auto uniform = std::make_shared<std::vector<float>>(actionSize, 1.0f / actionSize);
+    GameState start = connectFour->start();
+    benchmarks.push_back({"MCTSTree/expand", [expandTree, uniform, start](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            expandTree->reset(start);
+            expandTree->expand(expandTree->root(), uniform->data());
+        }
+        keep(expandTree->size());
+    }, 1.0});
+    auto lazyTree = std::make_shared<MCTSTree>(connectFour.get());
+    lazyTree->setLazyExpansion(true);
+    benchmarks.push_back({"MCTSTree/expand/lazy", [lazyTree, uniform, start](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            lazyTree->reset(start);
+            lazyTree->expand(lazyTree->root(), uniform->data());
+        }
+        keep(lazyTree->size());
+    }, 1.0});
+
+    auto selectTree = std::make_shared<MCTSTree>(connectFour.get());
+    auto expanded = growTree(*selectTree, *connectFour, 20000);
+    benchmarks.push_back({"MCTSTree/bestChild", [selectTree, expanded](long long n) {
+        size_t count = expanded->size();
+        for (long long i = 0; i < n; ++i) {
+            keep(selectTree->bestChild((*expanded)[static_cast<size_t>(i) % count]));
+        }
+    }, 1.0});
+
+    auto randomModel = std::make_shared<RandomModel>(stateSize, actionSize);
+    for (int simulations : {100, 1000, 10000}) {
+        auto mcts = std::make_shared<MCTS>(connectFour.get(), randomModel.get(), simulations, 1.0f);
+        benchmarks.push_back({"MCTS/search/" + std::to_string(simulations), [mcts, start](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                keep(mcts->search(start).data()[0]);
+            }
+        }, static_cast<double>(simulations)});
+    }
+    // The same searches compiled for ConnectFour, without virtual calls
+    for (int simulations : {100, 1000, 10000}) {
+        auto mcts = std::make_shared<BasicMCTS<ConnectFour>>(connectFour.get(), randomModel.get(), simulations, 1.0f);
+        benchmarks.push_back({"MCTS<ConnectFour>/search/" + std::to_string(simulations), [mcts, start](long long n) {
+            for (long long i = 0; i < n; ++i) {
+                keep(mcts->search(start).data()[0]);
+            }
+        }, static_cast<double>(simulations)});
+    }
+
+    std::shared_ptr<MLPModel> network;
+    try {
+        network = loadNetwork(weights, stateSize, actionSize);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    auto encoded = std::make_shared<std::vector<float>>(connectFour->encodeState(start));
+    benchmarks.push_back({"Model/predict/random", [randomModel, encoded](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            keep(randomModel->predict(*encoded).second);
+        }
+    }, 1.0});
+    benchmarks.push_back({"Model/predict/mlp", [network, encoded](long long n) {
+        for (long long i = 0; i < n; ++i) {
+            keep(network->predict(*encoded).second);
+        }
+    }, 1.0});
+    const int batch = 64;
+    auto states = std::make_shared<std::vector<float>>();
+    for (int i = 0; i < batch; ++i) {
+        states->insert(states->end(), encoded->begin(), encoded->end());
+    }
+    benchmarks.push_back({"Model/predictBatch/mlp/64", [network, states, stateSize, actionSize](long long n) {
+        std::vector<float> policies(static_cast<size_t>(batch) * actionSize);
+        std::vector<float> values(batch);
+        for (long long i = 0; i < n; ++i) {
+            network->predictBatch(states->data(), batch, stateSize, policies.data(), actionSize, values.data());
+            keep(values[0]);
+        }
+    }, static_cast<double>(batch)});
+
+    std::vector<Result> results;
+    std::cout << std::left << std::setw(32) << "benchmark" << std::right << std::setw(14) << "time (ns)"
+              << std::setw(14) << "iterations" << std::setw(16) << "items/s" << std::endl;
+    for (const Benchmark& benchmark : benchmarks) {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        Result result = run(benchmark, minTime);
+        results.push_back(result);
+        std::cout << std::left << std::setw(32) << result.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << result.realNs << std::setw(14) << result.iterations
+                  << std::setw(16) << std::setprecision(0) << result.itemsPerSecond << std::endl;
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream json(jsonPath);
+        writeJson(json, results, argv[0]);
+        if (!json) {
+            std::cerr << "Cannot write " << jsonPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
\ No newline at end of file
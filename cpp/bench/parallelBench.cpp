@@ -0,0 +1,99 @@
+#include "../algorithms/mcts.h"
+#include "../games/ConnectFour/ConnectFour.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Simulations per second of a ConnectFour search for 1..N threads, sharing
+// one tree (tree parallelism) and growing one tree per thread (root
+// parallelism), at the same total number of simulations. RandomModel costs
+// almost nothing, so an optional busy-wait per model call stands in for a
+// network forward pass. A batched call costs the same as a single one, like
+// a GPU that is far from saturated.
+//
+//   parallelBench [maxThreads] [numSimulations] [evalMicros] [batchSize]
+
+namespace {
+
+class BusyModel : public Model {
+public:
+    BusyModel(int stateSize, int actionSize, int evalMicros)
+        : inner(stateSize, actionSize), evalMicros(evalMicros) {
+    }
+
+    std::pair<std::vector<float>, float> predict(const std::vector<float>& encodedState) override {
+        busyWait();
+        return inner.predict(encodedState);
+    }
+
+    void predictBatch(const float* states, int batchSize, int stateSize,
+                      float* policies, int actionSize, float* values) override {
+        busyWait();
+        inner.predictBatch(states, batchSize, stateSize, policies, actionSize, values);
+    }
+
+private:
+    void busyWait() const {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(evalMicros);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+
+    RandomModel inner;
+    int evalMicros;
+};
+
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(std::thread::hardware_concurrency());
+    int numSimulations = argc > 2 ? std::atoi(argv[2]) : 20000;
+    int evalMicros = argc > 3 ? std::atoi(argv[3]) : 0;
+    int batchSize = argc > 4 ? std::atoi(argv[4]) : 1;
+    if (maxThreads < 1) maxThreads = 1;
+
+    ConnectFour game;
+    BusyModel model(game.stateSpaceSize(), game.actionSpaceSize(), evalMicros);
+    GameState start = game.start();
+
+    std::cout << "ConnectFour, " << numSimulations << " simulations per search, "
+              << evalMicros << " us per model call, batch size " << batchSize << std::endl;
+    std::cout << "threads  tree sims/sec  speedup  root sims/sec  speedup" << std::endl;
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    auto measure = [&](MCTS& mcts) {
+        mcts.search(start);  // warm up the arena
+
+        const int repeats = 3;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeats; ++i) {
+            mcts.search(start);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        return repeats * numSimulations / seconds;
+    };
+
+    double baseline = 0.0;
+    for (int threads : threadCounts) {
+        MCTS shared(&game, &model, numSimulations, 1.0f, threads, batchSize);
+        double treeSimsPerSec = measure(shared);
+        if (threads == 1) baseline = treeSimsPerSec;
+
+        MCTS independent(&game, &model, numSimulations, 1.0f, 1, batchSize);
+        independent.setRootParallel(threads);
+        double rootSimsPerSec = measure(independent);
+
+        std::cout << threads << "  " << static_cast<long long>(treeSimsPerSec)
+                  << "  " << treeSimsPerSec / baseline << "x"
+                  << "  " << static_cast<long long>(rootSimsPerSec)
+                  << "  " << rootSimsPerSec / baseline << "x" << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "../algorithms/mcts.h"
+#include "../algorithms/puct.h"
+#include "../games/ConnectFour/ConnectFour.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Times the PUCT selection step over every expanded node of a ConnectFour
+// tree: the per-child getUCB loop against the scalar and SIMD kernels that
+// read the sibling statistics arrays.
+
+namespace {
+
+void buildTree(MCTSTree& tree, ConnectFour& game, int numSimulations) {
+    std::vector<float> uniform(game.actionSpaceSize(), 1.0f / game.actionSpaceSize());
+    tree.reset(game.start());
+
+    for (int i = 0; i < numSimulations; ++i) {
+        NodeIndex leaf = tree.root();
+        while (tree.isFullyExpanded(leaf) && !tree.node(leaf).state.isTerminal) {
+            leaf = tree.bestChild(leaf);
+        }
+
+        float value = 0.0f;
+        if (!tree.node(leaf).state.isTerminal) {
+            tree.expand(leaf, uniform.data());
+        } else {
+            value = tree.node(leaf).reward;
+        }
+        tree.backpropagate(leaf, value);
+    }
+}
+
+NodeIndex getUCBLoop(const MCTSTree& tree, NodeIndex index) {
+    const MCTSNode& n = tree.node(index);
+    NodeIndex best = n.firstChild;
+    float bestUCB = tree.getUCB(index, best);
+    for (NodeIndex child = n.firstChild + 1; child < n.firstChild + n.numChildren; ++child) {
+        float ucb = tree.getUCB(index, child);
+        if (ucb > bestUCB) {
+            bestUCB = ucb;
+            best = child;
+        }
+    }
+    return best;
+}
+
+NodeIndex scalarKernel(const MCTSTree& tree, NodeIndex index, float explorationWeight) {
+    const MCTSNode& n = tree.node(index);
+    const NodeArena& arena = tree.nodes();
+    float sqrtVisits = std::sqrt(static_cast<float>(tree.visits(index)));
+    return n.firstChild + puctArgmaxScalar(arena.priors(n.firstChild),
+                                           arena.visitCounts(n.firstChild),
+                                           arena.valueSums(n.firstChild),
+                                           n.numChildren, explorationWeight, sqrtVisits);
+}
+
+template<typename Select>
+double nsPerSelection(const std::vector<NodeIndex>& nodes, Select select, long long& checksum) {
+    using clock = std::chrono::steady_clock;
+    long long selections = 0;
+    auto start = clock::now();
+    double elapsed = 0.0;
+    do {
+        for (NodeIndex index : nodes) {
+            checksum += select(index);
+        }
+        selections += static_cast<long long>(nodes.size());
+        elapsed = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+    } while (elapsed < 5e8);
+    return elapsed / selections;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int numSimulations = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const float explorationWeight = 1.0f;
+
+    ConnectFour game;
+    MCTSTree tree(&game, explorationWeight);
+    buildTree(tree, game, numSimulations);
+
+    std::vector<NodeIndex> expanded;
+    for (NodeIndex i = 0; i < static_cast<NodeIndex>(tree.size()); ++i) {
+        if (tree.built(i) && tree.node(i).numChildren > 0) {
+            expanded.push_back(i);
+        }
+    }
+
+    for (NodeIndex index : expanded) {
+        NodeIndex expected = getUCBLoop(tree, index);
+        if (tree.bestChild(index) != expected || scalarKernel(tree, index, explorationWeight) != expected) {
+            std::cerr << "Selection mismatch at node " << index << std::endl;
+            return 1;
+        }
+    }
+
+    long long checksum = 0;
+    double loopNs = nsPerSelection(expanded, [&](NodeIndex i) { return getUCBLoop(tree, i); }, checksum);
+    double scalarNs = nsPerSelection(expanded, [&](NodeIndex i) { return scalarKernel(tree, i, explorationWeight); }, checksum);
+    double simdNs = nsPerSelection(expanded, [&](NodeIndex i) { return tree.bestChild(i); }, checksum);
+
+    std::cout << "ConnectFour tree: " << numSimulations << " simulations, "
+              << expanded.size() << " expanded nodes" << std::endl;
+    std::cout << "getUCB loop:          " << loopNs << " ns/selection" << std::endl;
+    std::cout << "SoA scalar kernel:    " << scalarNs << " ns/selection ("
+              << loopNs / scalarNs << "x)" << std::endl;
+    std::cout << "SoA " << puctKernelName() << " kernel:      " << simdNs << " ns/selection ("
+              << loopNs / simdNs << "x)" << std::endl;
+    std::cout << "(checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "../algorithms/mcts.h"
+#include "../games/ConnectFour/ConnectFour.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Model calls per search with no cache, with the per-search transposition
+// table and with an evaluation cache shared by all searches. Plays the same
+// ConnectFour games (a different first move each, then always the most
+// visited move) every way and counts the states that reach the model.
+//
+//   transpositionBench [numSimulations] [numMoves] [numGames] [tableMB]
+
+namespace {
+
+class CountingModel : public Model {
+public:
+    CountingModel(int stateSize, int actionSize) : inner(stateSize, actionSize), evaluated(0) {
+    }
+
+    std::pair<std::vector<float>, float> predict(const std::vector<float>& encodedState) override {
+        evaluated.fetch_add(1, std::memory_order_relaxed);
+        return inner.predict(encodedState);
+    }
+
+    void predictBatch(const float* states, int batchSize, int stateSize,
+                      float* policies, int actionSize, float* values) override {
+        evaluated.fetch_add(batchSize, std::memory_order_relaxed);
+        inner.predictBatch(states, batchSize, stateSize, policies, actionSize, values);
+    }
+
+    long long count() const { return evaluated.load(); }
+
+private:
+    RandomModel inner;
+    std::atomic<long long> evaluated;
+};
+
+void play(int numSimulations, int numMoves, int numGames, std::size_t tableBytes, EvaluationCache* cache) {
+    ConnectFour game;
+    CountingModel model(game.stateSpaceSize(), game.actionSpaceSize());
+    MCTS mcts(&game, &model, numSimulations, 1.0f);
+    if (tableBytes > 0) {
+        mcts.enableTranspositionTable(tableBytes);
+    }
+    mcts.setEvaluationCache(cache);
+
+    int searches = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int g = 0; g < numGames; ++g) {
+        auto [first, r] = game.move(game.start(), g % game.actionSpaceSize());
+        GameState state = game.flipBoard(first);
+        for (int m = 0; m < numMoves && !state.isTerminal; ++m, ++searches) {
+            std::vector<float> probs = mcts.search(state);
+            int action = 0;
+            for (size_t i = 1; i < probs.size(); ++i) {
+                if (probs[i] > probs[action]) action = static_cast<int>(i);
+            }
+            auto [next, reward] = game.move(state, action);
+            state = game.flipBoard(next);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const char* name = cache ? "cache   " : (tableBytes ? "table   " : "none    ");
+    std::cout << name << "  model evals/search " << model.count() / std::max(searches, 1)
+              << "  time " << seconds << " s";
+    if (const TranspositionTable* table = mcts.transpositionTable()) {
+        TranspositionStats stats = table->stats();
+        std::cout << "  hit rate " << stats.hitRate() * 100.0 << "%"
+                  << "  replacements " << stats.replacements
+                  << "  (" << table->capacity() << " entries, " << table->bytes() / (1 << 20) << " MB)";
+    }
+    if (cache) {
+        EvaluationCacheStats stats = cache->stats();
+        std::cout << "  hit rate " << stats.hitRate() * 100.0 << "%"
+                  << "  evictions " << stats.evictions
+                  << "  (" << stats.entries << "/" << cache->capacity() << " entries, "
+                  << cache->bytes() / (1 << 20) << " MB)";
+    }
+    std::cout << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int numSimulations = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int numMoves = argc > 2 ? std::atoi(argv[2]) : 10;
+    int numGames = argc > 3 ? std::atoi(argv[3]) : 3;
+    std::size_t tableMB = argc > 4 ? std::atoi(argv[4]) : 16;
+
+    std::cout << "ConnectFour, " << numSimulations << " simulations per search, "
+              << numGames << " games of " << numMoves << " moves" << std::endl;
+    play(numSimulations, numMoves, numGames, 0, nullptr);
+    play(numSimulations, numMoves, numGames, tableMB << 20, nullptr);
+
+    ConnectFour game;
+    EvaluationCache cache(tableMB, game.actionSpaceSize());
+    play(numSimulations, numMoves, numGames, 0, &cache);
+    return 0;
+}
\ No newline at end of file
@@ -1,88 +1,470 @@
 #include "algorithms/mcts.h"
+#include "models/mlpModel.h"
 #include "games/ConnectFour/ConnectFour.h"
+#include "games/TicTacToe/TicTacToe.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
-#include <chrono>
 
-int main() {
-    const int numGames = 2;
-    int bot1Wins = 0, bot2Wins = 0, draws = 0;
-    long long bot1TotalTime = 0;
-    long long bot2TotalTime = 0;
-
-    for (int gameIdx = 0; gameIdx < numGames; ++gameIdx) {
-        auto model1 = std::make_unique<RandomModel>(42, 7);
-        auto model2 = std::make_unique<RandomModel>(42, 7);
-        auto game = std::make_unique<ConnectFour>();
-        MCTS mcts1(game.get(), model1.get(), 12700, 1.0f);
-        MCTS2 mcts2(game.get(), model2.get(), 10000, 1.0f);
-
-        GameState state = game->start();
-        bool bot1Turn = (gameIdx % 2 == 0); // Alternate starting player
-        float result = 0;
-
-        while (!state.isTerminal) {
-            int action = 0;
-            if (bot1Turn) {
-                auto start = std::chrono::high_resolution_clock::now();
-                std::vector<float> probs = mcts1.search(state);
-                auto end = std::chrono::high_resolution_clock::now();
-                bot1TotalTime += std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-                // Pick best action
-                int bestAction = 0;
-                float bestProb = probs[0];
-                for (size_t i = 1; i < probs.size(); ++i) {
-                    if (probs[i] > bestProb) {
-                        bestProb = probs[i];
-                        bestAction = static_cast<int>(i);
-                    }
-                }
-                action = bestAction;
-            } else {
-                auto start = std::chrono::high_resolution_clock::now();
-                std::vector<float> probs = mcts2.search(state);
-                auto end = std::chrono::high_resolution_clock::now();
-                bot2TotalTime += std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-                int bestAction = 0;
-                float bestProb = probs[0];
-                for (size_t i = 1; i < probs.size(); ++i) {
-                    if (probs[i] > bestProb) {
-                        bestProb = probs[i];
-                        bestAction = static_cast<int>(i);
-                    }
+// Tournament between two search engines.
+//
+//   botBattle [--game connectfour|tictactoe] [--games N] [--threads N]
+//             [--seed S] [--opening-plies N] [--engine1 SPEC] [--engine2 SPEC]
+//             [--sprt ELO0,ELO1] [--alpha A] [--beta B]
+//
+// An engine SPEC is a comma-separated list of key=value settings:
+//
+//     sims      simulations per move, 0 for no limit (800)
+//     ms        milliseconds per move, 0 for no limit (0)
+//     nodes     tree size limit per move, 0 for none (0)
+//     decided   1 stops a search once its move can no longer change (0)
+//     threads   tree-parallel search threads (1)
+//     batch     leaves per model call (1)
+//     trees     root-parallel trees (1)
+//     reuse     1 keeps the subtree of the move played (MCTS2) (0)
+//     ponder    1 searches on during the opponent's move; needs reuse=1
+//               and a spare core per game (0)
+//     mb        tree memory limit in MB with reuse=1, 0 for none (0)
+//     model     exported weight file (uniform random model if missing)
+//     cpuct     exploration weight (1.0)
+//
+// Games are played in pairs from the same random opening, each engine moving
+// first once, and numThreads games run at once. Engines play the most
+// visited move, so game i depends only on the seed and i. With --sprt the
+// tournament stops once the games played so far, taken in order, accept or
+// reject "engine1 is elo1 stronger" against "elo0 stronger", which keeps the
+// stopping point reproducible too. Only engines with an ms limit or
+// ponder=1 make results depend on timing; a pondering engine's tree depends
+// on how long its opponent thought.
+
+namespace {
+
+struct EngineConfig {
+    int simulations = 800;
+    int moveMillis = 0;
+    std::size_t maxNodes = 0;
+    bool stopWhenDecided = false;
+    int threads = 1;
+    int batchSize = 1;
+    int trees = 1;
+    bool reuse = false;
+    bool ponder = false;
+    std::size_t memoryMB = 0;
+    std::string modelPath;
+    float explorationWeight = 1.0f;
+};
+
+EngineConfig parseEngine(const std::string& spec) {
+    EngineConfig config;
+    std::stringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("Engine setting '" + item + "' is not key=value");
+        }
+        std::string key = item.substr(0, equals);
+        std::string value = item.substr(equals + 1);
+        if (key == "sims") {
+            config.simulations = std::stoi(value);
+        } else if (key == "ms") {
+            config.moveMillis = std::stoi(value);
+        } else if (key == "nodes") {
+            config.maxNodes = std::stoull(value);
+        } else if (key == "decided") {
+            config.stopWhenDecided = std::stoi(value) != 0;
+        } else if (key == "threads") {
+            config.threads = std::stoi(value);
+        } else if (key == "batch") {
+            config.batchSize = std::stoi(value);
+        } else if (key == "trees") {
+            config.trees = std::stoi(value);
+        } else if (key == "reuse") {
+            config.reuse = std::stoi(value) != 0;
+        } else if (key == "ponder") {
+            config.ponder = std::stoi(value) != 0;
+        } else if (key == "mb") {
+            config.memoryMB = std::stoull(value);
+        } else if (key == "model") {
+            config.modelPath = value;
+        } else if (key == "cpuct") {
+            config.explorationWeight = std::stof(value);
+        } else {
+            throw std::invalid_argument("Unknown engine setting '" + key + "'");
+        }
+    }
+    if (config.simulations <= 0 && config.moveMillis <= 0 && config.maxNodes == 0) {
+        throw std::invalid_argument("An engine needs a sims, ms or nodes limit");
+    }
+    if (config.ponder && !config.reuse) {
+        throw std::invalid_argument("Pondering needs reuse=1");
+    }
+    if (config.memoryMB > 0 && !config.reuse) {
+        throw std::invalid_argument("A memory limit needs reuse=1");
+    }
+    if (config.reuse && config.trees > 1) {
+        throw std::invalid_argument("Tree reuse and root-parallel trees cannot be combined");
+    }
+    return config;
+}
+
+// One engine's search state for one game
+class Player {
+public:
+    virtual ~Player() = default;
+    virtual std::vector<float> search(const GameState& state) = 0;
+};
+
+template<typename Search>
+class SearchPlayer : public Player {
+public:
+    SearchPlayer(Game<int>* game, Model* model, const EngineConfig& config)
+        : engine(game, model, config.simulations, config.explorationWeight, config.threads, config.batchSize),
+          config(config) {
+    }
+
+    std::vector<float> search(const GameState& state) override {
+        SearchLimits limits;
+        if (config.moveMillis > 0) {
+            limits = SearchLimits::time(config.moveMillis / 1000.0);
+        }
+        limits.simulations = config.simulations;
+        limits.nodes = config.maxNodes;
+        limits.stopWhenDecided = config.stopWhenDecided;
+        return engine.search(state, limits);
+    }
+
+    Search engine;
+    EngineConfig config;
+};
+
+// An engine configuration and its model, shared by every game
+struct Engine {
+    EngineConfig config;
+    std::unique_ptr<Model> model;
+
+    std::unique_ptr<Player> newPlayer(Game<int>* game, uint64_t seed) const {
+        if (config.reuse) {
+            auto player = std::make_unique<SearchPlayer<MCTS2>>(game, model.get(), config);
+            player->engine.setPondering(config.ponder);
+            player->engine.setMemoryLimit(config.memoryMB << 20);
+            return player;
+        }
+        auto player = std::make_unique<SearchPlayer<MCTS>>(game, model.get(), config);
+        if (config.trees > 1) {
+            player->engine.setRootParallel(config.trees, seed);
+        }
+        return player;
+    }
+};
+
+Engine loadEngine(const EngineConfig& config, Game<int>* game) {
+    Engine engine;
+    engine.config = config;
+    if (config.modelPath.empty()) {
+        engine.model = std::make_unique<RandomModel>(game->stateSpaceSize(), game->actionSpaceSize());
+    } else {
+        auto mlp = std::make_unique<MLPModel>(config.modelPath);
+        if (mlp->stateSize() != game->stateSpaceSize() || mlp->actionSize() != game->actionSpaceSize()) {
+            throw std::invalid_argument(config.modelPath + " does not fit the game");
+        }
+        engine.model = std::move(mlp);
+    }
+    return engine;
+}
+
+// Random moves from the start position that never end the game. Returns
+// the state seen by the player to move next.
+GameState randomOpening(Game<int>* game, int plies, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    GameState state = game->start();
+    for (int ply = 0; ply < plies; ++ply) {
+        std::vector<int> actions = game->getValidActions(state);
+        std::shuffle(actions.begin(), actions.end(), rng);
+        bool moved = false;
+        for (int action : actions) {
+            GameState next = game->move(state, action).first;
+            if (!next.isTerminal) {
+                state = game->flipBoard(next);
+                moved = true;
+                break;
+            }
+        }
+        if (!moved) {
+            break;
+        }
+    }
+    return state;
+}
+
+int mostVisited(const std::vector<float>& probs) {
+    return static_cast<int>(std::max_element(probs.begin(), probs.end()) - probs.begin());
+}
+
+struct GameResult {
+    float score = 0.0f;               // for engine1: 1 win, 0.5 draw, 0 loss
+    std::vector<double> latency[2];   // seconds per move, by engine
+};
+
+// Plays game index of the tournament
+GameResult playGame(Game<int>* game, const Engine* engines[2], int index, uint64_t seed, int openingPlies) {
+    GameState state = randomOpening(game, openingPlies, mixSeed(seed, index / 2));
+    std::unique_ptr<Player> players[2] = {
+        engines[0]->newPlayer(game, mixSeed(seed ^ 0x5bd1e995, index)),
+        engines[1]->newPlayer(game, mixSeed(seed ^ 0x1b873593, index)),
+    };
+
+    // Engine1 makes the first move after the opening in even games
+    int toMove = index % 2;
+    GameResult result;
+    for (;;) {
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<float> probs = players[toMove]->search(state);
+        result.latency[toMove].push_back(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+
+        auto [next, reward] = game->move(state, mostVisited(probs));
+        if (next.isTerminal) {
+            // reward is for the engine that just moved
+            float moverScore = reward > 0.0f ? 1.0f : (reward < 0.0f ? 0.0f : 0.5f);
+            result.score = toMove == 0 ? moverScore : 1.0f - moverScore;
+            return result;
+        }
+        state = game->flipBoard(next);
+        toMove = 1 - toMove;
+    }
+}
+
+struct Score {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double mean() const { return games() > 0 ? (wins + 0.5 * draws) / games() : 0.5; }
+
+    // Variance of a single game's score
+    double variance() const {
+        if (games() == 0) {
+            return 0.0;
+        }
+        double s = mean();
+        return (wins * (1.0 - s) * (1.0 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / games();
+    }
+
+    void add(float score) {
+        if (score > 0.75f) {
+            wins++;
+        } else if (score < 0.25f) {
+            losses++;
+        } else {
+            draws++;
+        }
+    }
+};
+
+double eloFromScore(double score) {
+    score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double scoreFromElo(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Log-likelihood ratio of elo1 over elo0, normal approximation of the
+// trinomial game score
+double sprtLLR(const Score& score, double elo0, double elo1) {
+    double variance = score.variance();
+    if (variance <= 0.0) {
+        return 0.0;
+    }
+    double s0 = scoreFromElo(elo0);
+    double s1 = scoreFromElo(elo1);
+    return score.games() * (s1 - s0) * (2.0 * score.mean() - s0 - s1) / (2.0 * variance);
+}
+
+double percentile(std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+    rank = std::min(std::max<size_t>(rank, 1), values.size());
+    std::nth_element(values.begin(), values.begin() + (rank - 1), values.end());
+    return values[rank - 1];
+}
+
+void usage() {
+    std::cerr << "usage: botBattle [--game connectfour|tictactoe] [--games N] [--threads N]\n"
+              << "                 [--seed S] [--opening-plies N] [--engine1 SPEC] [--engine2 SPEC]\n"
+              << "                 [--sprt ELO0,ELO1] [--alpha A] [--beta B]\n"
+              << "SPEC: sims=N,ms=N,nodes=N,decided=0|1,threads=N,batch=N,trees=N,reuse=0|1,ponder=0|1,\n"
+              << "      mb=N,model=FILE,cpuct=C"
+              << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string gameName = "connectfour";
+    int numGames = 100;
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 1;
+    int openingPlies = 4;
+    std::string spec1 = "sims=12700";
+    std::string spec2 = "sims=10000,reuse=1";
+    bool sprt = false;
+    double elo0 = 0.0, elo1 = 10.0;
+    double alpha = 0.05, beta = 0.05;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (flag == "--game") {
+            gameName = value;
+        } else if (flag == "--games") {
+            numGames = std::atoi(value.c_str());
+        } else if (flag == "--threads") {
+            numThreads = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--seed") {
+            seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--opening-plies") {
+            openingPlies = std::atoi(value.c_str());
+        } else if (flag == "--engine1") {
+            spec1 = value;
+        } else if (flag == "--engine2") {
+            spec2 = value;
+        } else if (flag == "--sprt") {
+            sprt = std::sscanf(value.c_str(), "%lf,%lf", &elo0, &elo1) == 2;
+            if (!sprt) {
+                usage();
+                return 1;
+            }
+        } else if (flag == "--alpha") {
+            alpha = std::atof(value.c_str());
+        } else if (flag == "--beta") {
+            beta = std::atof(value.c_str());
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::unique_ptr<Game<int>> game;
+    if (gameName == "connectfour") {
+        game = std::make_unique<ConnectFour>();
+    } else if (gameName == "tictactoe") {
+        game = std::make_unique<TicTacToe>();
+    } else {
+        usage();
+        return 1;
+    }
+
+    Engine engine1, engine2;
+    try {
+        engine1 = loadEngine(parseEngine(spec1), game.get());
+        engine2 = loadEngine(parseEngine(spec2), game.get());
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    const Engine* engines[2] = {&engine1, &engine2};
+
+    std::cout << gameName << ", " << numGames << " games on " << numThreads << " threads, seed " << seed
+              << ", " << openingPlies << " random opening plies" << std::endl;
+    std::cout << "engine1: " << spec1 << std::endl;
+    std::cout << "engine2: " << spec2 << std::endl;
+
+    // Scores by game index. Only the longest completed prefix is counted, so
+    // the SPRT decision does not depend on which thread finished first.
+    std::vector<float> scores(numGames, -1.0f);
+    std::vector<double> latency[2];
+    Score score;
+    double lowerBound = std::log(beta / (1.0 - alpha));
+    double upperBound = std::log((1.0 - beta) / alpha);
+    int decision = 0;   // 1 accepted elo1, -1 accepted elo0
+    std::mutex resultsMutex;
+    std::atomic<int> nextGame(0);
+    std::atomic<bool> stop(false);
+
+    auto worker = [&]() {
+        for (;;) {
+            int index = nextGame.fetch_add(1);
+            if (index >= numGames || stop.load()) {
+                break;
+            }
+            GameResult result = playGame(game.get(), engines, index, seed, openingPlies);
+
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            scores[index] = result.score;
+            for (int e = 0; e < 2; ++e) {
+                latency[e].insert(latency[e].end(), result.latency[e].begin(), result.latency[e].end());
+            }
+            while (decision == 0 && score.games() < numGames && scores[score.games()] >= 0.0f) {
+                score.add(scores[score.games()]);
+                double llr = sprtLLR(score, elo0, elo1);
+                if (sprt && (llr >= upperBound || llr <= lowerBound)) {
+                    decision = llr >= upperBound ? 1 : -1;
+                    stop = true;
                 }
-                action = bestAction;
             }
-            auto [nextState, reward] = game->move(state, action);
-            state = game->flipBoard(nextState);
-            bot1Turn = !bot1Turn;
-            result = reward;
-
-            // if (bot1Turn) {
-            //     game->displayBoard(state);
-            // } else {
-            //     game->displayBoard(nextState);
-            // }
-        }
-
-        // Game ended, check result
-        if (!bot1Turn) { // bot1 ended the game
-            if (result > 0) bot1Wins++;
-            else if (result < 0) bot2Wins++;
-            else draws++;
-        } else { // bot2 ended the game
-            if (result > 0) bot2Wins++;
-            else if (result < 0) bot1Wins++;
-            else draws++;
-        }
-    }
-
-    std::cout << "After " << numGames << " games between two MCTS bots:" << std::endl;
-    std::cout << "Bot1 wins: " << bot1Wins << std::endl;
-    std::cout << "Bot2 wins: " << bot2Wins << std::endl;
-    std::cout << "Draws: " << draws << std::endl;
-    std::cout << "Bot1 total thinking time: " << bot1TotalTime << " ms" << std::endl;
-    std::cout << "Bot2 total thinking time: " << bot2TotalTime << " ms" << std::endl;
+        }
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> helpers;
+    for (int t = 1; t < numThreads; ++t) {
+        helpers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    int n = score.games();
+    double mean = score.mean();
+    double margin = n > 0 ? 1.96 * std::sqrt(score.variance() / n) : 0.0;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\nengine1 vs engine2 after " << n << " games (" << seconds << " s)" << std::endl;
+    std::cout << "W/D/L: " << score.wins << " / " << score.draws << " / " << score.losses << std::endl;
+    std::cout << std::setprecision(3) << "score: " << mean << " +- " << margin << " (95%)" << std::endl;
+    std::cout << std::setprecision(1) << "elo: " << eloFromScore(mean) << " ["
+              << eloFromScore(mean - margin) << ", " << eloFromScore(mean + margin) << "]" << std::endl;
+    if (sprt) {
+        std::cout << std::setprecision(2) << "SPRT elo0=" << elo0 << " elo1=" << elo1
+                  << ": LLR " << sprtLLR(score, elo0, elo1) << " [" << lowerBound << ", " << upperBound << "] "
+                  << (decision > 0 ? "H1 accepted" : decision < 0 ? "H0 accepted" : "inconclusive") << std::endl;
+    }
+
+    std::cout << std::setprecision(2) << "move latency ms      p50     p90     p99     max" << std::endl;
+    for (int e = 0; e < 2; ++e) {
+        std::cout << "engine" << e + 1 << "        ";
+        for (double p : {0.5, 0.9, 0.99, 1.0}) {
+            std::cout << std::setw(8) << 1000.0 * percentile(latency[e], p);
+        }
+        std::cout << "  (" << latency[e].size() << " moves)" << std::endl;
+    }
     return 0;
-}
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "sampleWriter.h"
+#include <cstring>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "SampleWriter writes little-endian sample files directly"
+#endif
+
+namespace {
+
+const char SAMPLES_MAGIC[8] = {'A', '0', 'S', 'A', 'M', 'P', 'L', 'E'};
+const char CHUNK_MAGIC[8] = {'A', '0', 'C', 'H', 'U', 'N', 'K', '\0'};
+
+}
+
+SampleWriter::SampleWriter(const std::string& path, int stateSize, int actionSize, Mode mode, int chunkRecords)
+    : file(nullptr), stateSize(stateSize), actionSize(actionSize), chunkRecords(chunkRecords), written(0) {
+    if (stateSize <= 0 || actionSize <= 0 || chunkRecords <= 0) {
+        throw std::invalid_argument("Sample and chunk sizes must be positive");
+    }
+
+    if (mode == Mode::APPEND) {
+        file = std::fopen(path.c_str(), "r+b");
+        if (file != nullptr) {
+            try {
+                openExisting(path);
+            } catch (...) {
+                std::fclose(file);
+                throw;
+            }
+            pending.reserve(static_cast<std::size_t>(chunkRecords) * recordFloats());
+            return;
+        }
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("Cannot open sample file " + path);
+    }
+
+    SampleFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SAMPLES_MAGIC, sizeof(SAMPLES_MAGIC));
+    header.version = VERSION;
+    header.stateSize = static_cast<uint32_t>(stateSize);
+    header.actionSize = static_cast<uint32_t>(actionSize);
+    header.recordBytes = static_cast<uint32_t>(recordFloats() * sizeof(float));
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        std::fclose(file);
+        throw std::runtime_error("Cannot write sample file " + path);
+    }
+    pending.reserve(static_cast<std::size_t>(chunkRecords) * recordFloats());
+}
+
+SampleWriter::~SampleWriter() {
+    if (file != nullptr) {
+        try {
+            flush();
+        } catch (...) {
+        }
+        std::fclose(file);
+    }
+}
+
+// Checks the header, counts the complete chunks and truncates whatever
+// follows them so new chunks start on a chunk boundary.
+void SampleWriter::openExisting(const std::string& path) {
+    SampleFileHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, SAMPLES_MAGIC, sizeof(SAMPLES_MAGIC)) != 0) {
+        throw std::invalid_argument(path + " is not a sample file");
+    }
+    if (header.version != VERSION) {
+        throw std::invalid_argument(path + " has unsupported sample format version " +
+                                    std::to_string(header.version));
+    }
+    if (header.stateSize != static_cast<uint32_t>(stateSize) ||
+        header.actionSize != static_cast<uint32_t>(actionSize)) {
+        throw std::invalid_argument(path + " holds samples of a different game");
+    }
+
+    struct stat info;
+    if (::fstat(::fileno(file), &info) != 0) {
+        throw std::runtime_error("Cannot read sample file " + path);
+    }
+    uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+    uint64_t recordBytes = header.recordBytes;
+
+    uint64_t offset = sizeof(SampleFileHeader);
+    for (;;) {
+        SampleChunkHeader chunk;
+        if (offset + sizeof(chunk) > fileSize || std::fseek(file, static_cast<long>(offset), SEEK_SET) != 0 ||
+            std::fread(&chunk, sizeof(chunk), 1, file) != 1 ||
+            std::memcmp(chunk.magic, CHUNK_MAGIC, sizeof(CHUNK_MAGIC)) != 0) {
+            break;
+        }
+        uint64_t end = offset + sizeof(chunk) + chunk.records * recordBytes;
+        if (end > fileSize) {
+            break;
+        }
+        written += chunk.records;
+        offset = end;
+    }
+
+    if (offset < fileSize && ::ftruncate(::fileno(file), static_cast<off_t>(offset)) != 0) {
+        throw std::runtime_error("Cannot drop the incomplete chunk of " + path);
+    }
+    std::fseek(file, static_cast<long>(offset), SEEK_SET);
+}
+
+void SampleWriter::writeChunk(const float* records, int count) {
+    SampleChunkHeader chunk;
+    std::memset(&chunk, 0, sizeof(chunk));
+    std::memcpy(chunk.magic, CHUNK_MAGIC, sizeof(CHUNK_MAGIC));
+    chunk.records = static_cast<uint32_t>(count);
+    chunk.firstRecord = static_cast<uint64_t>(written);
+
+    std::size_t floats = static_cast<std::size_t>(count) * recordFloats();
+    if (std::fwrite(&chunk, sizeof(chunk), 1, file) != 1 ||
+        std::fwrite(records, sizeof(float), floats, file) != floats) {
+        throw std::runtime_error("Cannot write samples");
+    }
+    written += count;
+}
+
+void SampleWriter::append(const float* records, int count) {
+    if (count <= 0) {
+        return;
+    }
+    std::size_t floats = static_cast<std::size_t>(count) * recordFloats();
+    std::size_t chunkFloats = static_cast<std::size_t>(chunkRecords) * recordFloats();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.insert(pending.end(), records, records + floats);
+    if (pending.size() < chunkFloats) {
+        return;
+    }
+
+    std::size_t full = pending.size() / chunkFloats;
+    for (std::size_t i = 0; i < full; ++i) {
+        writeChunk(pending.data() + i * chunkFloats, chunkRecords);
+    }
+    pending.erase(pending.begin(), pending.begin() + full * chunkFloats);
+}
+
+void SampleWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pending.empty()) {
+        writeChunk(pending.data(), static_cast<int>(pending.size() / recordFloats()));
+        pending.clear();
+    }
+    std::fflush(file);
+}
+
+long long SampleWriter::records() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written + static_cast<long long>(pending.size() / recordFloats());
+}
\ No newline at end of file
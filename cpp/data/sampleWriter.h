@@ -0,0 +1,88 @@
+#ifndef SAMPLE_WRITER_H
+#define SAMPLE_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Replay buffer of training samples from self-play: an append-only file of
+// chunks, read back by replay_buffer.py through numpy.memmap.
+//
+// Layout, all little-endian:
+//
+//     SampleFileHeader                          at offset 0
+//     SampleChunkHeader, records[records]       repeated until end of file
+//
+// A record is float32 state[stateSize], float32 policy[actionSize] and a
+// float32 outcome for the player to move in that state (1 win, 0 draw,
+// -1 loss). Records are recordBytes apart, so every chunk is one strided
+// array. A chunk cut short by a crash is ignored by readers and dropped by
+// the next writer that appends to the file.
+struct SampleFileHeader {
+    char magic[8];          // "A0SAMPLE"
+    uint32_t version;
+    uint32_t stateSize;
+    uint32_t actionSize;
+    uint32_t recordBytes;
+    uint64_t reserved;
+};
+
+struct SampleChunkHeader {
+    char magic[8];          // "A0CHUNK\0"
+    uint32_t records;
+    uint32_t reserved;
+    uint64_t firstRecord;   // index of the chunk's first record in the file
+    uint64_t padding;
+};
+
+static_assert(sizeof(SampleFileHeader) == 32, "sample file header is 32 bytes");
+static_assert(sizeof(SampleChunkHeader) == 32, "sample chunk headers are 32 bytes");
+
+class SampleWriter {
+public:
+    static const uint32_t VERSION = 2;
+    static const int DEFAULT_CHUNK_RECORDS = 4096;
+
+    enum class Mode {
+        TRUNCATE,   // start a new file
+        APPEND      // keep the records of an existing file, if any
+    };
+
+    // Opens path for writing. Records are buffered and written out in
+    // chunks of chunkRecords. Throws if the file cannot be written or, when
+    // appending, holds samples of other sizes.
+    SampleWriter(const std::string& path, int stateSize, int actionSize, Mode mode = Mode::TRUNCATE,
+                 int chunkRecords = DEFAULT_CHUNK_RECORDS);
+    // Writes out the buffered records
+    ~SampleWriter();
+
+    SampleWriter(const SampleWriter&) = delete;
+    SampleWriter& operator=(const SampleWriter&) = delete;
+
+    int recordFloats() const { return stateSize + actionSize + 1; }
+
+    // Appends count records laid out back to back. Safe to call from
+    // several threads; the records of one call stay contiguous.
+    void append(const float* records, int count);
+    // Writes the buffered records as a (possibly short) chunk
+    void flush();
+
+    // Records in the file, buffered ones included
+    long long records() const;
+
+private:
+    void openExisting(const std::string& path);
+    void writeChunk(const float* records, int count);
+
+    std::FILE* file;
+    int stateSize;
+    int actionSize;
+    int chunkRecords;
+    long long written;
+    std::vector<float> pending;
+    mutable std::mutex mutex;
+};
+
+#endif // SAMPLE_WRITER_H
\ No newline at end of file
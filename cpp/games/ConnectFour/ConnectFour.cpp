@@ -1,172 +1,69 @@
 #include "ConnectFour.h"
 #include <stdexcept>
 #include <iostream>
+#include <utility>
+
+ConnectFour::ZobristTable::ZobristTable() : keys() {
+    for (int col = 0; col < COLS; col++) {
+        for (int row = 0; row < ROWS; row++) {
+            int bit = col * COL_BITS + row;
+            int image = (COLS - 1 - col) * COL_BITS + row;
+            keys[0][bit] = zobristKey(col * ROWS + row);
+            keys[1][image] = flipHash(keys[0][bit]);
+        }
+    }
+}
+
+const ConnectFour::ZobristTable ConnectFour::ZOBRIST;
 
 ConnectFour::ConnectFour() = default;
 ConnectFour::~ConnectFour() = default;
 
 GameState ConnectFour::start() {
-    auto* initialState = new std::array<std::array<int, COLS>, ROWS>();
-    for (auto& row : *initialState) {
-        row.fill(0);
-    }
-    return GameState(initialState, false);
+    Board initialState;
+    initialState.current = 0;
+    initialState.opponent = 0;
+    initialState.heights.fill(0);
+    return GameState(initialState, false, 0);
 }
 
 bool ConnectFour::checkEq(const GameState& lhs, const GameState& rhs) const {
+    const auto& a = lhs.board<Board>();
+    const auto& b = rhs.board<Board>();
     return lhs.isTerminal == rhs.isTerminal &&
-           *static_cast<std::array<std::array<int, COLS>, ROWS>*>(lhs.state) ==
-           *static_cast<std::array<std::array<int, COLS>, ROWS>*>(rhs.state);
+           a.current == b.current &&
+           a.opponent == b.opponent;
 }
 
-bool ConnectFour::checkWinner(const std::array<std::array<int, COLS>, ROWS>& state) {
-    // Check horizontal, vertical, and diagonal connections
-    for (int row = 0; row < ROWS; row++) {
-        for (int col = 0; col < COLS; col++) {
-            if (state[row][col] == 1) {
-                // Horizontal
-                if (col + 3 < COLS) {
-                    bool win = true;
-                    for (int i = 0; i < 4; i++) {
-                        if (state[row][col + i] != 1) {
-                            win = false;
-                            break;
-                        }
-                    }
-                    if (win) return true;
-                }
-
-                // Vertical
-                if (row + 3 < ROWS) {
-                    bool win = true;
-                    for (int i = 0; i < 4; i++) {
-                        if (state[row + i][col] != 1) {
-                            win = false;
-                            break;
-                        }
-                    }
-                    if (win) return true;
-                }
-
-                // Diagonal
-                if (row - 3 >= 0 && col + 3 < COLS) {
-                    bool win = true;
-                    for (int i = 0; i < 4; i++) {
-                        if (state[row - i][col + i] != 1) {
-                            win = false;
-                            break;
-                        }
-                    }
-                    if (win) return true;
-                }
-
-                // Other Diagonal
-                if (row + 3 < ROWS && col + 3 < COLS) {
-                    bool win = true;
-                    for (int i = 0; i < 4; i++) {
-                        if (state[row + i][col + i] != 1) {
-                            win = false;
-                            break;
-                        }
-                    }
-                    if (win) return true;
-                }
-            }
-        }
-    }
-    return false;
-}
-
-std::pair<GameState, float> ConnectFour::move(const GameState& state, int action) {
-    if (!isValidAction(state, action)) {
-        throw std::invalid_argument("Invalid action");
-    }
-
-    auto* currentState = static_cast<std::array<std::array<int, COLS>, ROWS>*>(state.state);
-    auto* newState = new std::array<std::array<int, COLS>, ROWS>(*currentState);
-
-    // Get row idx
-    int rowIdx = ROWS - 1;
-    while (rowIdx >= 0 && (*newState)[rowIdx][action] != 0) {
-        rowIdx--;
-    }
-
-    (*newState)[rowIdx][action] = 1;
-
-    bool isTerminal = checkWinner(*newState);
-    float reward = isTerminal? 1:0;
-    if (!isTerminal) {
-        // Check if board is full
-        isTerminal = true;
-        for (const auto& row : *newState) {
-            for (int cell : row) {
-                if (cell == 0) {
-                    isTerminal = false;
-                    break;
-                }
-            }
-            if (!isTerminal) break;
+uint64_t ConnectFour::computeHash(const GameState& state) const {
+    const auto& board = state.board<Board>();
+    uint64_t hash = 0;
+    const uint64_t stones[2] = {board.current, board.opponent};
+    for (int side = 0; side < 2; side++) {
+        for (uint64_t rest = stones[side]; rest; rest &= rest - 1) {
+            hash ^= ZOBRIST.keys[side][__builtin_ctzll(rest)];
         }
     }
-
-    return std::make_pair(GameState(newState, isTerminal), reward);
+    return hash;
 }
 
 void ConnectFour::setState(GameState& state, int player) {
-    auto* board = static_cast<std::array<std::array<int, COLS>, ROWS>*>(state.state);
+    auto& board = state.board<Board>();
     if (player == -1) {
-        for (auto& row : *board) {
-            for (int& cell : row) {
-                cell = -cell;
-            }
-        }
-    }
-}
-
-GameState ConnectFour::flipBoard(const GameState& state) {
-    auto* currentState = static_cast<std::array<std::array<int, COLS>, ROWS>*>(state.state);
-    auto* newState = new std::array<std::array<int, COLS>, ROWS>();
-
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLS; j++) {
-            (*newState)[i][COLS - 1 - j] = -(*currentState)[i][j];
-        }
+        std::swap(board.current, board.opponent);
     }
-
-    return GameState(newState, state.isTerminal);
-}
-
-bool ConnectFour::isValidAction(const GameState& state, int action) {
-    if (action > 6 || action < 0) return false;
-    auto* board = static_cast<std::array<std::array<int, COLS>, ROWS>*>(state.state);
-    return (*board)[0][action] == 0;
+    state.hash = computeHash(state);
 }
 
 std::vector<int> ConnectFour::getValidActions(const GameState& state) {
-    std::vector<int> validActions;
-    for (int action = 0; action < COLS; action++) {
-        if (isValidAction(state, action)) {
-            validActions.push_back(action);
-        }
-    }
-    return validActions;
-}
-
-float ConnectFour::getOpponentReward(float reward) {
-    return -reward;
+    std::vector<int> actions(COLS);
+    actions.resize(validActions(state, actions.data()));
+    return actions;
 }
 
 std::vector<float> ConnectFour::encodeState(const GameState& state) {
-    auto* board = static_cast<std::array<std::array<int, COLS>, ROWS>*>(state.state);
-    std::vector<float> encoded;
-    encoded.reserve(ROWS * COLS);
-
-    for (const auto& row : *board) {
-        for (int cell : row) {
-            encoded.push_back(static_cast<float>(cell));
-        }
-    }
-
+    std::vector<float> encoded(ROWS * COLS);
+    encode(state, encoded.data());
     return encoded;
 }
 
@@ -179,21 +76,21 @@ int ConnectFour::stateSpaceSize() {
 }
 
 void ConnectFour::displayBoard(const GameState& state) const {
-    auto* board = static_cast<std::array<std::array<int, COLS>, ROWS>*>(state.state);
-    
+    const auto& board = state.board<Board>();
+
     // Print column numbers
     std::cout << "  ";
     for (int col = 0; col < COLS; col++) {
         std::cout << col << " ";
     }
     std::cout << std::endl;
-    
+
     // Print the board
     for (int row = 0; row < ROWS; row++) {
         std::cout << "| ";
         for (int col = 0; col < COLS; col++) {
             char symbol;
-            switch ((*board)[row][col]) {
+            switch (cellAt(board, row, col)) {
                 case 1:  symbol = 'X'; break;  // Current player
                 case -1: symbol = 'O'; break;  // Opponent
                 case 0:  symbol = '.'; break;  // Empty
@@ -203,7 +100,7 @@ void ConnectFour::displayBoard(const GameState& state) const {
         }
         std::cout << "|" << std::endl;
     }
-    
+
     // Print bottom border
     std::cout << "+";
     for (int col = 0; col < COLS; col++) {
@@ -3,9 +3,31 @@
 
 #include "../GameEnv.h"
 #include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
 
-class ConnectFour : public Game<int> {
+// final, and the search hot paths are defined here, so code that holds a
+// ConnectFour (e.g. BasicMCTS<ConnectFour>) calls them without going
+// through the vtable and can inline them
+class ConnectFour final : public Game<int> {
 public:
+    static const int ROWS = 6;
+    static const int COLS = 7;
+    static constexpr int ACTION_SIZE = COLS;
+    static constexpr int STATE_SIZE = ROWS * COLS;
+
+    // Bitboard layout: each column takes ROWS + 1 bits, bottom cell first.
+    // The extra bit per column stays empty so shifted masks never wrap
+    // from one column into the next.
+    static const int COL_BITS = ROWS + 1;
+
+    struct Board {
+        uint64_t current;   // stones of the player to move, encoded as 1
+        uint64_t opponent;  // stones of the other player, encoded as -1
+        std::array<uint8_t, COLS> heights;
+    };
+
     ConnectFour();
     ~ConnectFour() override;
 
@@ -15,20 +37,137 @@ public:
     GameState flipBoard(const GameState& state) override;
     bool isValidAction(const GameState& state, int action) override;
     std::vector<int> getValidActions(const GameState& state) override;
-    float getOpponentReward(float reward) override;
+    float getOpponentReward(float reward) override { return -reward; }
     std::vector<float> encodeState(const GameState& state) override;
     int actionSpaceSize() override;
     int stateSpaceSize() override;
-    
+
+    // Allocation-free forms of getValidActions() and encodeState(), writing
+    // at most ACTION_SIZE actions and exactly STATE_SIZE values
+    int validActions(const GameState& state, int* actions) const;
+    void encode(const GameState& state, float* encoded) const;
+
     // Helper method to display the board
-    void displayBoard(const GameState& state) const;
+    void displayBoard(const GameState& state) const override;
+
+    bool checkEq(const GameState& lhs, const GameState& rhs) const override;
+    uint64_t computeHash(const GameState& state) const override;
 
-    bool checkEq(const GameState& lhs, const GameState& rhs) const;
+    // True if stones hold four in a row
+    static bool checkWinner(uint64_t stones);
 
 private:
-    bool checkWinner(const std::array<std::array<int, 7>, 6>& state);
-    static const int ROWS = 6;
-    static const int COLS = 7;
+    // Zobrist keys by side and bit index. Flipping mirrors the columns, so
+    // the side 1 key of a bit is the rotated side 0 key of its mirror image.
+    struct ZobristTable {
+        uint64_t keys[2][COLS * COL_BITS];
+        ZobristTable();
+    };
+    static const ZobristTable ZOBRIST;
+
+    static uint64_t mirror(uint64_t stones);
+    static int cellAt(const Board& board, int row, int col);
 };
 
+inline bool ConnectFour::checkWinner(uint64_t stones) {
+    // Horizontal
+    uint64_t m = stones & (stones >> COL_BITS);
+    if (m & (m >> (2 * COL_BITS))) return true;
+
+    // Diagonal
+    m = stones & (stones >> (COL_BITS - 1));
+    if (m & (m >> (2 * (COL_BITS - 1)))) return true;
+
+    // Other Diagonal
+    m = stones & (stones >> (COL_BITS + 1));
+    if (m & (m >> (2 * (COL_BITS + 1)))) return true;
+
+    // Vertical
+    m = stones & (stones >> 1);
+    if (m & (m >> 2)) return true;
+
+    return false;
+}
+
+inline uint64_t ConnectFour::mirror(uint64_t stones) {
+    const uint64_t columnMask = (1ULL << ROWS) - 1;
+    uint64_t mirrored = 0;
+    for (int col = 0; col < COLS; col++) {
+        uint64_t column = (stones >> (col * COL_BITS)) & columnMask;
+        mirrored |= column << ((COLS - 1 - col) * COL_BITS);
+    }
+    return mirrored;
+}
+
+inline int ConnectFour::cellAt(const Board& board, int row, int col) {
+    uint64_t bit = 1ULL << (col * COL_BITS + (ROWS - 1 - row));
+    if (board.current & bit) return 1;
+    if (board.opponent & bit) return -1;
+    return 0;
+}
+
+inline std::pair<GameState, float> ConnectFour::move(const GameState& state, int action) {
+    if (!isValidAction(state, action)) {
+        throw std::invalid_argument("Invalid action");
+    }
+
+    Board newState = state.board<Board>();
+
+    int bit = action * COL_BITS + newState.heights[action];
+    newState.current |= 1ULL << bit;
+    newState.heights[action]++;
+    uint64_t hash = state.hash ^ ZOBRIST.keys[0][bit];
+
+    bool isTerminal = checkWinner(newState.current);
+    float reward = isTerminal? 1:0;
+    if (!isTerminal) {
+        // Check if board is full
+        isTerminal = __builtin_popcountll(newState.current | newState.opponent) == ROWS * COLS;
+    }
+
+    return std::make_pair(GameState(newState, isTerminal, hash), reward);
+}
+
+inline GameState ConnectFour::flipBoard(const GameState& state) {
+    // Swap sides and mirror the columns, matching the array layout where
+    // cell (i, j) moved to (i, COLS - 1 - j) with its sign negated.
+    const auto& currentState = state.board<Board>();
+    Board newState;
+
+    newState.current = mirror(currentState.opponent);
+    newState.opponent = mirror(currentState.current);
+    for (int col = 0; col < COLS; col++) {
+        newState.heights[COLS - 1 - col] = currentState.heights[col];
+    }
+
+    return GameState(newState, state.isTerminal, flipHash(state.hash));
+}
+
+inline bool ConnectFour::isValidAction(const GameState& state, int action) {
+    if (action > 6 || action < 0) return false;
+    return state.board<Board>().heights[action] < ROWS;
+}
+
+inline int ConnectFour::validActions(const GameState& state, int* actions) const {
+    const auto& board = state.board<Board>();
+    int count = 0;
+    for (int action = 0; action < COLS; action++) {
+        if (board.heights[action] < ROWS) {
+            actions[count++] = action;
+        }
+    }
+    return count;
+}
+
+inline void ConnectFour::encode(const GameState& state, float* encoded) const {
+    const auto& board = state.board<Board>();
+    for (int row = 0; row < ROWS; row++) {
+        for (int col = 0; col < COLS; col++) {
+            int bit = col * COL_BITS + (ROWS - 1 - row);
+            int cell = static_cast<int>((board.current >> bit) & 1) - static_cast<int>((board.opponent >> bit) & 1);
+            *encoded++ = static_cast<float>(cell);
+        }
+    }
+}
+
 #endif // CONNECTFOUR_H
\ No newline at end of file
@@ -1,8 +1,19 @@
 #include "GameEnv.h"
 
 // GameState implementation
-GameState::GameState(void* state, bool isTerminal) 
-    : state(state), isTerminal(isTerminal) {
+GameState::GameState()
+    : storage(), hash(0), isTerminal(false) {
+}
+
+uint64_t zobristKey(int index) {
+    return mixSeed(0, static_cast<uint64_t>(index));
+}
+
+uint64_t mixSeed(uint64_t seed, uint64_t index) {
+    uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
 }
 
 // Game implementation
@@ -12,4 +23,6 @@ Game<T>::Game() {
 
 template<typename T>
 Game<T>::~Game() {
-}
\ No newline at end of file
+}
+
+template class Game<int>;
\ No newline at end of file
@@ -3,15 +3,82 @@
 
 #include <vector>
 #include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <algorithm>
 
+// Game states are plain values: each game stores its board inline in a
+// fixed-size buffer, so copying a state never touches the heap and a
+// discarded state needs no cleanup.
+//
+// hash is the Zobrist hash of the board. Games keep it up to date
+// incrementally in move() and flipBoard().
 class GameState {
 public:
-    GameState(void* state = nullptr, bool isTerminal = false);
+    static constexpr std::size_t CAPACITY = 24;
 
-    void* state;
+    GameState();
+
+    template<typename Board>
+    GameState(const Board& board, bool isTerminal, uint64_t hash)
+        : storage(), hash(hash), isTerminal(isTerminal) {
+        checkBoardType<Board>();
+        new (storage) Board(board);
+    }
+
+    template<typename Board>
+    Board& board() {
+        checkBoardType<Board>();
+        return *std::launder(reinterpret_cast<Board*>(storage));
+    }
+
+    template<typename Board>
+    const Board& board() const {
+        checkBoardType<Board>();
+        return *std::launder(reinterpret_cast<const Board*>(storage));
+    }
+
+    alignas(8) unsigned char storage[CAPACITY];
+    uint64_t hash;
     bool isTerminal;
+
+private:
+    template<typename Board>
+    static constexpr void checkBoardType() {
+        static_assert(std::is_trivially_copyable<Board>::value, "Board must be trivially copyable");
+        static_assert(sizeof(Board) <= CAPACITY, "Board does not fit in GameState::CAPACITY");
+        static_assert(alignof(Board) <= 8, "Board alignment exceeds GameState storage alignment");
+    }
 };
 
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must stay a plain value");
+
+// Zobrist keys. A board's hash is the XOR of one key per stone, indexed by
+// side (0 for the player to move, 1 for the opponent) and cell.
+//
+// flipBoard() swaps the sides and may also move each cell to an image cell
+// (ConnectFour mirrors columns). Keys of side 1 are derived from side 0 so
+// that flipping a board rotates its hash by 32 bits:
+//
+//     key(1, image(cell)) == flipHash(key(0, cell))
+//
+// The flipped hash then costs one rotation. The price is that a board and
+// its own flipped image collide with probability 2^-32 instead of 2^-64.
+inline uint64_t flipHash(uint64_t hash) {
+    return (hash << 32) | (hash >> 32);
+}
+
+// Fixed pseudo-random key for side 0 of cell index, the same in every run
+uint64_t zobristKey(int index);
+
+// splitmix64: the index-th of a stream of well mixed values derived from
+// seed. Used for Zobrist keys and for per-game seeds of self-play and
+// tournaments.
+uint64_t mixSeed(uint64_t seed, uint64_t index);
+
+template<typename T>
 class Game {
 public:
     Game();
@@ -30,6 +97,73 @@ public:
     // Helper method to display the board
     virtual void displayBoard(const GameState& state) const = 0;
     virtual bool checkEq(const GameState& lhs, const GameState& rhs) const = 0;
+    // Zobrist hash of the board computed from scratch. Equals state.hash
+    // for every state produced by start(), move() and flipBoard().
+    virtual uint64_t computeHash(const GameState& state) const = 0;
+};
+
+// Actions in a fixed-capacity array, for games whose action space size N
+// is known at compile time. Reads like the std::vector<int> of
+// getValidActions().
+template<int N>
+struct ActionList {
+    int actions[N];
+    int count = 0;
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int operator[](int i) const { return actions[i]; }
+    const int* begin() const { return actions; }
+    const int* end() const { return actions + count; }
+};
+
+// What the search engine needs to know about a game type G. Games that know
+// their sizes at compile time declare
+//
+//     static constexpr int ACTION_SIZE, STATE_SIZE;
+//     int validActions(const GameState& state, int* actions) const;   // returns the count
+//     void encode(const GameState& state, float* encoded) const;
+//
+// and are searched without virtual calls or heap buffers. Any other game,
+// Game<int> included, goes through the virtual interface and reports sizes
+// of 0, meaning known only at run time.
+template<typename G, typename = void>
+struct GameTraits {
+    static constexpr int ACTION_SIZE = 0;
+    static constexpr int STATE_SIZE = 0;
+    using Actions = std::vector<int>;
+
+    static int actionSize(G& game) { return game.actionSpaceSize(); }
+    static int stateSize(G& game) { return game.stateSpaceSize(); }
+
+    static Actions validActions(G& game, const GameState& state) {
+        return game.getValidActions(state);
+    }
+
+    static void encode(G& game, const GameState& state, float* encoded) {
+        std::vector<float> values = game.encodeState(state);
+        std::copy(values.begin(), values.end(), encoded);
+    }
+};
+
+template<typename G>
+struct GameTraits<G, std::void_t<decltype(G::ACTION_SIZE), decltype(G::STATE_SIZE)>> {
+    static constexpr int ACTION_SIZE = G::ACTION_SIZE;
+    static constexpr int STATE_SIZE = G::STATE_SIZE;
+    using Actions = ActionList<ACTION_SIZE>;
+
+    static constexpr int actionSize(G&) { return ACTION_SIZE; }
+    static constexpr int stateSize(G&) { return STATE_SIZE; }
+
+    static Actions validActions(G& game, const GameState& state) {
+        Actions actions;
+        actions.count = game.validActions(state, actions.actions);
+        return actions;
+    }
+
+    static void encode(G& game, const GameState& state, float* encoded) {
+        game.encode(state, encoded);
+    }
 };
 
 #endif // GAME_ENV_H
\ No newline at end of file
@@ -1,132 +1,92 @@
 #include "TicTacToe.h"
 #include <algorithm>
 #include <stdexcept>
+#include <iostream>
 
-TicTacToe::TicTacToe() = default;
-TicTacToe::~TicTacToe() = default;
-
-GameState TicTacToe::start() {
-    auto* initialState = new std::array<std::array<int, 3>, 3>();
-    for (auto& row : *initialState) {
-        row.fill(0);
-    }
-    return GameState(initialState, false);
-}
-
-bool TicTacToe::checkWinner(const std::array<std::array<int, 3>, 3>& state) {
-    // Check rows and columns
-    for (int i = 0; i < 3; i++) {
-        if ((state[i][0] == 1 && state[i][1] == 1 && state[i][2] == 1) ||
-            (state[0][i] == 1 && state[1][i] == 1 && state[2][i] == 1)) {
-            return true;
-        }
-    }
-    
-    // Check diagonals
-    if ((state[0][0] == 1 && state[1][1] == 1 && state[2][2] == 1) ||
-        (state[0][2] == 1 && state[1][1] == 1 && state[2][0] == 1)) {
-        return true;
+TicTacToe::ZobristTable::ZobristTable() : keys() {
+    for (int cell = 0; cell < 9; cell++) {
+        keys[0][cell] = zobristKey(cell);
+        keys[1][8 - cell] = flipHash(keys[0][cell]);
     }
-    
-    return false;
 }
 
-std::pair<GameState, float> TicTacToe::move(const GameState& state, int action) {
-    if (!isValidAction(state, action)) {
-        throw std::invalid_argument("Invalid action");
-    }
+const TicTacToe::ZobristTable TicTacToe::ZOBRIST;
 
-    auto* currentState = static_cast<std::array<std::array<int, 3>, 3>*>(state.state);
-    auto* newState = new std::array<std::array<int, 3>, 3>(*currentState);
-    
-    int row = action / 3;
-    int col = action % 3;
-    (*newState)[row][col] = 1;
+TicTacToe::TicTacToe() = default;
+TicTacToe::~TicTacToe() = default;
 
-    bool isTerminal = checkWinner(*newState);
-    float reward = isTerminal? 1:0;
-    if (!isTerminal) {
-        // Check if board is full
-        isTerminal = true;
-        for (const auto& row : *newState) {
-            for (int cell : row) {
-                if (cell == 0) {
-                    isTerminal = false;
-                    break;
-                }
-            }
-            if (!isTerminal) break;
-        }
+GameState TicTacToe::start() {
+    Board initialState;
+    for (auto& row : initialState) {
+        row.fill(0);
     }
-
-    return std::make_pair(GameState(newState, isTerminal), reward);
+    return GameState(initialState, false, 0);
 }
 
 void TicTacToe::setState(GameState& state, int player) {
-    auto* board = static_cast<std::array<std::array<int, 3>, 3>*>(state.state);
+    auto& board = state.board<Board>();
     if (player == -1) {
-        for (auto& row : *board) {
-            for (int& cell : row) {
+        for (auto& row : board) {
+            for (int8_t& cell : row) {
                 cell = -cell;
             }
         }
     }
+    state.hash = computeHash(state);
 }
 
-GameState TicTacToe::flipBoard(const GameState& state) {
-    auto* currentState = static_cast<std::array<std::array<int, 3>, 3>*>(state.state);
-    auto* newState = new std::array<std::array<int, 3>, 3>();
-    
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            (*newState)[2-i][2-j] = -(*currentState)[i][j];
-        }
-    }
-    
-    return GameState(newState, state.isTerminal);
+std::vector<int> TicTacToe::getValidActions(const GameState& state) {
+    std::vector<int> actions(9);
+    actions.resize(validActions(state, actions.data()));
+    return actions;
 }
 
-bool TicTacToe::isValidAction(const GameState& state, int action) {
-    if (state.isTerminal) return false;
-    
-    auto* board = static_cast<std::array<std::array<int, 3>, 3>*>(state.state);
-    int row = action / 3;
-    int col = action % 3;
-    return (*board)[row][col] == 0;
+std::vector<float> TicTacToe::encodeState(const GameState& state) {
+    std::vector<float> encoded(9);
+    encode(state, encoded.data());
+    return encoded;
 }
 
-std::vector<int> TicTacToe::getValidActions(const GameState& state) {
-    std::vector<int> validActions;
-    for (int action = 0; action < 9; action++) {
-        if (isValidAction(state, action)) {
-            validActions.push_back(action);
-        }
-    }
-    return validActions;
+int TicTacToe::actionSpaceSize() {
+    return 9;
 }
 
-float TicTacToe::getOpponentReward(float reward) {
-    return -reward;
+int TicTacToe::stateSpaceSize() {
+    return 9;
 }
 
-std::vector<float> TicTacToe::encodeState(const GameState& state) {
-    auto* board = static_cast<std::array<std::array<int, 3>, 3>*>(state.state);
-    std::vector<float> encoded;
-    encoded.reserve(9);
-    
-    for (const auto& row : *board) {
-        for (int cell : row) {
-            encoded.push_back(static_cast<float>(cell));
+void TicTacToe::displayBoard(const GameState& state) const {
+    const auto& board = state.board<Board>();
+
+    for (const auto& row : board) {
+        std::cout << "| ";
+        for (int8_t cell : row) {
+            char symbol;
+            switch (cell) {
+                case 1:  symbol = 'X'; break;  // Current player
+                case -1: symbol = 'O'; break;  // Opponent
+                case 0:  symbol = '.'; break;  // Empty
+                default: symbol = '?'; break;  // Unknown
+            }
+            std::cout << symbol << " ";
         }
+        std::cout << "|" << std::endl;
     }
-    
-    return encoded;
 }
 
-int TicTacToe::actionSpaceSize() {
-    return 9;
+bool TicTacToe::checkEq(const GameState& lhs, const GameState& rhs) const {
+    return lhs.isTerminal == rhs.isTerminal &&
+           lhs.board<Board>() == rhs.board<Board>();
 }
 
-int TicTacToe::stateSpaceSize() {
-    return 9;
+uint64_t TicTacToe::computeHash(const GameState& state) const {
+    const auto& board = state.board<Board>();
+    uint64_t hash = 0;
+    for (int cell = 0; cell < 9; cell++) {
+        int8_t stone = board[cell / 3][cell % 3];
+        if (stone != 0) {
+            hash ^= ZOBRIST.keys[stone == 1 ? 0 : 1][cell];
+        }
+    }
+    return hash;
 }
\ No newline at end of file
@@ -3,9 +3,18 @@
 
 #include "../GameEnv.h"
 #include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
 
-class TicTacToe : public Game<int> {
+// final with its search hot paths defined here, like ConnectFour
+class TicTacToe final : public Game<int> {
 public:
+    using Board = std::array<std::array<int8_t, 3>, 3>;
+
+    static constexpr int ACTION_SIZE = 9;
+    static constexpr int STATE_SIZE = 9;
+
     TicTacToe();
     ~TicTacToe() override;
 
@@ -15,13 +24,125 @@ public:
     GameState flipBoard(const GameState& state) override;
     bool isValidAction(const GameState& state, int action) override;
     std::vector<int> getValidActions(const GameState& state) override;
-    float getOpponentReward(float reward) override;
+    float getOpponentReward(float reward) override { return -reward; }
     std::vector<float> encodeState(const GameState& state) override;
     int actionSpaceSize() override;
     int stateSpaceSize() override;
 
+    // Allocation-free forms of getValidActions() and encodeState(), writing
+    // at most ACTION_SIZE actions and exactly STATE_SIZE values
+    int validActions(const GameState& state, int* actions) const;
+    void encode(const GameState& state, float* encoded) const;
+
+    // Helper method to display the board
+    void displayBoard(const GameState& state) const override;
+
+    bool checkEq(const GameState& lhs, const GameState& rhs) const override;
+    uint64_t computeHash(const GameState& state) const override;
+
+    // True if the stones encoded as 1 hold three in a row
+    bool checkWinner(const Board& state);
+
 private:
-    bool checkWinner(const std::array<std::array<int, 3>, 3>& state);
+    // Zobrist keys by side and cell (row * 3 + col). Flipping rotates the
+    // board by 180 degrees, which maps cell i to 8 - i.
+    struct ZobristTable {
+        uint64_t keys[2][9];
+        ZobristTable();
+    };
+    static const ZobristTable ZOBRIST;
 };
 
+inline bool TicTacToe::checkWinner(const Board& state) {
+    // Check rows and columns
+    for (int i = 0; i < 3; i++) {
+        if ((state[i][0] == 1 && state[i][1] == 1 && state[i][2] == 1) ||
+            (state[0][i] == 1 && state[1][i] == 1 && state[2][i] == 1)) {
+            return true;
+        }
+    }
+
+    // Check diagonals
+    if ((state[0][0] == 1 && state[1][1] == 1 && state[2][2] == 1) ||
+        (state[0][2] == 1 && state[1][1] == 1 && state[2][0] == 1)) {
+        return true;
+    }
+
+    return false;
+}
+
+inline std::pair<GameState, float> TicTacToe::move(const GameState& state, int action) {
+    if (!isValidAction(state, action)) {
+        throw std::invalid_argument("Invalid action");
+    }
+
+    Board newState = state.board<Board>();
+
+    int row = action / 3;
+    int col = action % 3;
+    newState[row][col] = 1;
+    uint64_t hash = state.hash ^ ZOBRIST.keys[0][action];
+
+    bool isTerminal = checkWinner(newState);
+    float reward = isTerminal? 1:0;
+    if (!isTerminal) {
+        // Check if board is full
+        isTerminal = true;
+        for (const auto& row : newState) {
+            for (int cell : row) {
+                if (cell == 0) {
+                    isTerminal = false;
+                    break;
+                }
+            }
+            if (!isTerminal) break;
+        }
+    }
+
+    return std::make_pair(GameState(newState, isTerminal, hash), reward);
+}
+
+inline GameState TicTacToe::flipBoard(const GameState& state) {
+    const auto& currentState = state.board<Board>();
+    Board newState;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            newState[2-i][2-j] = -currentState[i][j];
+        }
+    }
+
+    return GameState(newState, state.isTerminal, flipHash(state.hash));
+}
+
+inline bool TicTacToe::isValidAction(const GameState& state, int action) {
+    if (state.isTerminal) return false;
+
+    const auto& board = state.board<Board>();
+    int row = action / 3;
+    int col = action % 3;
+    return board[row][col] == 0;
+}
+
+inline int TicTacToe::validActions(const GameState& state, int* actions) const {
+    if (state.isTerminal) return 0;
+
+    const auto& board = state.board<Board>();
+    int count = 0;
+    for (int action = 0; action < 9; action++) {
+        if (board[action / 3][action % 3] == 0) {
+            actions[count++] = action;
+        }
+    }
+    return count;
+}
+
+inline void TicTacToe::encode(const GameState& state, float* encoded) const {
+    for (const auto& row : state.board<Board>()) {
+        for (int cell : row) {
+            *encoded++ = static_cast<float>(cell);
+        }
+    }
+}
+
 #endif // TICTACTOE_H
\ No newline at end of file
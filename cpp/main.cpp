@@ -1,18 +1,24 @@
 #include "algorithms/mcts.h"
+#include "models/mlpModel.h"
 #include "games/ConnectFour/ConnectFour.h"
 #include "games/TicTacToe/TicTacToe.h"
-#include <chrono>
 #include <iostream>
 #include <memory>
 
 
-int main() {
-    // Create a random model and ConnectFour game
-    auto model = std::make_unique<RandomModel>(42, 7); // ConnectFour state/action sizes
+int main(int argc, char** argv) {
+    // Use exported network weights if given, a random model otherwise
+    std::unique_ptr<Model> model;
+    if (argc > 1) {
+        model = std::make_unique<MLPModel>(argv[1]);
+    } else {
+        model = std::make_unique<RandomModel>(42, 7); // ConnectFour state/action sizes
+    }
     auto game = std::make_unique<ConnectFour>();
     
-    // Initialize MCTS
-    MCTS mcts(game.get(), model.get(), 10000, 1.0f);
+    // Initialize MCTS; it keeps searching while the human thinks
+    MCTS2 mcts(game.get(), model.get(), 10000, 1.0f);
+    mcts.setPondering(true);
     
     // Start the game
     GameState state = game->start(); // From AI's perspective
@@ -53,10 +59,12 @@ int main() {
         
         // AI move
         std::cout << "\nAI is thinking..." << std::endl;
-        auto start = std::chrono::high_resolution_clock::now();
-        std::vector<float> probs = mcts.search(state);
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        // Up to 10000 simulations or two seconds, less once the move is clear
+        SearchLimits limits = SearchLimits::time(2.0);
+        limits.simulations = 10000;
+        limits.stopWhenDecided = true;
+        SearchStats stats;
+        std::vector<float> probs = mcts.search(state, limits, &stats);
 
         // Find the action with highest probability
         int bestAction = 0;
@@ -69,7 +77,13 @@ int main() {
         }
 
         std::cout << "AI chooses column: " << bestAction 
-                  << " (took " << duration << " ms)" << std::endl;
+                  << " (took " << static_cast<long long>(stats.seconds * 1000.0) << " ms, "
+                  << stats.simulations << " simulations, " << stats.ponderSimulations << " pondered, "
+                  << stats.nodesAllocated << " nodes, " << stats.treeBytes / 1024 << " KB)" << std::endl;
+        if (SEARCH_PROFILING) {
+            stats.writeJson(std::cout);
+            std::cout << std::endl;
+        }
         
         // Apply AI move
         auto [nextState, _] = game->move(state, bestAction);
@@ -0,0 +1,139 @@
+#include "dense.h"
+#include <cstddef>
+
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(ALPHA0_NO_SIMD)
+#define DENSE_X86 1
+#include <immintrin.h>
+#endif
+
+void denseForwardScalar(const float* X, int batch, int in, const float* WT, const float* bias,
+                        int outStride, float* Y, bool relu) {
+    for (int b = 0; b < batch; ++b) {
+        const float* x = X + static_cast<size_t>(b) * in;
+        float* y = Y + static_cast<size_t>(b) * outStride;
+        for (int o = 0; o < outStride; ++o) {
+            y[o] = bias[o];
+        }
+        for (int i = 0; i < in; ++i) {
+            const float* w = WT + static_cast<size_t>(i) * outStride;
+            float xi = x[i];
+            for (int o = 0; o < outStride; ++o) {
+                y[o] += xi * w[o];
+            }
+        }
+        if (relu) {
+            for (int o = 0; o < outStride; ++o) {
+                y[o] = y[o] > 0.0f ? y[o] : 0.0f;
+            }
+        }
+    }
+}
+
+namespace {
+
+#ifdef DENSE_X86
+
+// Register tile of ROWS inputs x COLS * 8 outputs. Each weight vector loaded
+// from WT is reused for all ROWS inputs, so a batch of four reads the weights
+// a quarter as often as four separate calls.
+template<int ROWS, int COLS>
+__attribute__((target("avx2,fma"), always_inline)) inline
+void denseTileAVX2(const float* X, int in, const float* WT, const float* bias,
+                   int outStride, float* Y, int col, bool relu) {
+    __m256 acc[ROWS][COLS];
+    for (int c = 0; c < COLS; ++c) {
+        __m256 b = _mm256_loadu_ps(bias + col + 8 * c);
+        for (int r = 0; r < ROWS; ++r) {
+            acc[r][c] = b;
+        }
+    }
+
+    const float* w = WT + col;
+    for (int i = 0; i < in; ++i, w += outStride) {
+        __m256 wv[COLS];
+        for (int c = 0; c < COLS; ++c) {
+            wv[c] = _mm256_loadu_ps(w + 8 * c);
+        }
+        for (int r = 0; r < ROWS; ++r) {
+            __m256 xv = _mm256_broadcast_ss(X + static_cast<size_t>(r) * in + i);
+            for (int c = 0; c < COLS; ++c) {
+                acc[r][c] = _mm256_fmadd_ps(xv, wv[c], acc[r][c]);
+            }
+        }
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+    for (int r = 0; r < ROWS; ++r) {
+        float* y = Y + static_cast<size_t>(r) * outStride + col;
+        for (int c = 0; c < COLS; ++c) {
+            __m256 v = relu ? _mm256_max_ps(acc[r][c], zero) : acc[r][c];
+            _mm256_storeu_ps(y + 8 * c, v);
+        }
+    }
+}
+
+// Fewer rows leave registers for wider column tiles. Keeping eight
+// independent accumulators hides the FMA latency even for a single input.
+template<int ROWS>
+__attribute__((target("avx2,fma")))
+void denseRowsAVX2(const float* X, int in, const float* WT, const float* bias,
+                   int outStride, float* Y, bool relu) {
+    constexpr int COLS = ROWS == 1 ? 8 : (ROWS == 2 ? 4 : 2);
+    int col = 0;
+    for (; col + 8 * COLS <= outStride; col += 8 * COLS) {
+        denseTileAVX2<ROWS, COLS>(X, in, WT, bias, outStride, Y, col, relu);
+    }
+    for (; col < outStride; col += 8) {
+        denseTileAVX2<ROWS, 1>(X, in, WT, bias, outStride, Y, col, relu);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void denseForwardAVX2(const float* X, int batch, int in, const float* WT, const float* bias,
+                      int outStride, float* Y, bool relu) {
+    int b = 0;
+    for (; b + 4 <= batch; b += 4) {
+        denseRowsAVX2<4>(X + static_cast<size_t>(b) * in, in, WT, bias, outStride,
+                         Y + static_cast<size_t>(b) * outStride, relu);
+    }
+    const float* x = X + static_cast<size_t>(b) * in;
+    float* y = Y + static_cast<size_t>(b) * outStride;
+    switch (batch - b) {
+        case 3: denseRowsAVX2<3>(x, in, WT, bias, outStride, y, relu); break;
+        case 2: denseRowsAVX2<2>(x, in, WT, bias, outStride, y, relu); break;
+        case 1: denseRowsAVX2<1>(x, in, WT, bias, outStride, y, relu); break;
+        default: break;
+    }
+}
+
+#endif
+
+using DenseKernel = void (*)(const float*, int, int, const float*, const float*, int, float*, bool);
+
+struct KernelChoice {
+    DenseKernel kernel;
+    const char* name;
+};
+
+KernelChoice selectKernel() {
+#ifdef DENSE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {denseForwardAVX2, "avx2+fma"};
+    }
+#endif
+    return {denseForwardScalar, "scalar"};
+}
+
+const KernelChoice selected = selectKernel();
+
+}
+
+void denseForward(const float* X, int batch, int in, const float* WT, const float* bias,
+                  int outStride, float* Y, bool relu) {
+    selected.kernel(X, batch, in, WT, bias, outStride, Y, relu);
+}
+
+const char* denseKernelName() {
+    return selected.name;
+}
\ No newline at end of file
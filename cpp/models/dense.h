@@ -0,0 +1,26 @@
+#ifndef DENSE_H
+#define DENSE_H
+
+// Fully connected layer over a batch of rows, with bias and optional ReLU
+// fused into the same pass:
+//
+//     Y[b][o] = act(bias[o] + sum_i X[b][i] * WT[i][o])
+//
+// X holds batch rows of in floats. WT is the weight matrix transposed to
+// in x outStride, so each input feature scales one contiguous row of weights.
+// outStride must be a multiple of DENSE_LANES; weight and bias columns past
+// the real output size must be zero, which keeps the padded outputs at zero.
+// Y holds batch rows of outStride floats.
+const int DENSE_LANES = 8;
+
+void denseForward(const float* X, int batch, int in, const float* WT, const float* bias,
+                  int outStride, float* Y, bool relu);
+
+// Portable reference implementation, also used where no SIMD path applies
+void denseForwardScalar(const float* X, int batch, int in, const float* WT, const float* bias,
+                        int outStride, float* Y, bool relu);
+
+// Name of the kernel denseForward dispatches to on this machine
+const char* denseKernelName();
+
+#endif // DENSE_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "mlpModel.h"
+#include "dense.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+MLPModel::MLPModel(const std::string& path) : weights(path), scalarKernels(false) {
+}
+
+void MLPModel::forward(const float* states, int batchSize, float* policies, float* values) const {
+    auto dense = scalarKernels ? denseForwardScalar : denseForward;
+    const int numActions = weights.actionSize();
+
+    // Activations ping-pong between two per-thread buffers that only grow
+    thread_local std::vector<float> bufferA;
+    thread_local std::vector<float> bufferB;
+
+    const float* x = states;
+    for (const WeightFile::Layer& layer : weights.layers()) {
+        std::vector<float>& out = (x == bufferA.data()) ? bufferB : bufferA;
+        size_t needed = static_cast<size_t>(batchSize) * layer.outStride;
+        if (out.size() < needed) {
+            out.resize(needed);
+        }
+        dense(x, batchSize, layer.in, layer.weightsT, layer.bias, layer.outStride, out.data(),
+              layer.activation == WeightFile::RELU);
+        x = out.data();
+    }
+
+    const int headStride = weights.layers().back().outStride;
+    for (int b = 0; b < batchSize; ++b) {
+        const float* row = x + static_cast<size_t>(b) * headStride;
+        float* policy = policies + static_cast<size_t>(b) * numActions;
+
+        float maxLogit = *std::max_element(row, row + numActions);
+        float total = 0.0f;
+        for (int a = 0; a < numActions; ++a) {
+            policy[a] = std::exp(row[a] - maxLogit);
+            total += policy[a];
+        }
+        for (int a = 0; a < numActions; ++a) {
+            policy[a] /= total;
+        }
+        values[b] = std::tanh(row[numActions]);
+    }
+}
+
+std::pair<std::vector<float>, float> MLPModel::predict(const std::vector<float>& encodedState) {
+    if (static_cast<int>(encodedState.size()) != weights.stateSize()) {
+        throw std::invalid_argument("Encoded state size does not match the model");
+    }
+    std::vector<float> policy(weights.actionSize());
+    float value;
+    forward(encodedState.data(), 1, policy.data(), &value);
+    return {policy, value};
+}
+
+void MLPModel::predictBatch(const float* states, int batchSize, int stateSize,
+                            float* policies, int actionSize, float* values) {
+    if (stateSize != weights.stateSize() || actionSize != weights.actionSize()) {
+        throw std::invalid_argument("Batch shape does not match the model");
+    }
+    if (batchSize > 0) {
+        forward(states, batchSize, policies, values);
+    }
+}
\ No newline at end of file
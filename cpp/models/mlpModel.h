@@ -0,0 +1,42 @@
+#ifndef MLP_MODEL_H
+#define MLP_MODEL_H
+
+#include "../algorithms/model.h"
+#include "weightFile.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Native forward pass of networks.py's BasicPolicyValueNetwork: a stack of
+// ReLU layers followed by a softmax policy head and a tanh value head. The
+// two heads share their input, so they are exported as one fused layer.
+//
+// Weights are read in place from a memory-mapped file written by
+// export_weights.py (see weightFile.h). The model is read-only after
+// construction, so predict() and predictBatch() may run on several threads
+// at once.
+class MLPModel : public Model {
+public:
+    explicit MLPModel(const std::string& path);
+
+    std::pair<std::vector<float>, float> predict(const std::vector<float>& encodedState) override;
+    void predictBatch(const float* states, int batchSize, int stateSize,
+                      float* policies, int actionSize, float* values) override;
+
+    uint64_t version() const override { return weights.checksum(); }
+
+    int stateSize() const { return weights.stateSize(); }
+    int actionSize() const { return weights.actionSize(); }
+
+    // Runs the portable kernels instead of the dispatched ones. Used to
+    // check the SIMD path against the reference.
+    void setScalarKernels(bool scalar) { scalarKernels = scalar; }
+
+private:
+    void forward(const float* states, int batchSize, float* policies, float* values) const;
+
+    WeightFile weights;
+    bool scalarKernels;
+};
+
+#endif // MLP_MODEL_H
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "weightFile.h"
+#include "dense.h"
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "WeightFile maps little-endian weight files directly"
+#endif
+
+namespace {
+
+const char WEIGHTS_MAGIC[8] = {'A', '0', 'W', 'E', 'I', 'G', 'H', 'T'};
+
+}
+
+WeightFile::WeightFile(const std::string& path) : data(nullptr), size(0), contentHash(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open weight file " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(WeightFileHeader))) {
+        ::close(fd);
+        throw std::invalid_argument(path + " is too small to be a weight file");
+    }
+    size = static_cast<std::size_t>(info.st_size);
+
+    // Read-only shared mapping: the page cache holds the only copy
+    data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        data = nullptr;
+        throw std::runtime_error("Cannot map weight file " + path);
+    }
+    ::madvise(data, size, MADV_WILLNEED);
+
+    try {
+        validate(path);
+    } catch (...) {
+        ::munmap(data, size);
+        throw;
+    }
+}
+
+WeightFile::~WeightFile() {
+    if (data != nullptr) {
+        ::munmap(data, size);
+    }
+}
+
+void WeightFile::validate(const std::string& path) {
+    const WeightFileHeader& head = header();
+    if (std::memcmp(head.magic, WEIGHTS_MAGIC, sizeof(WEIGHTS_MAGIC)) != 0) {
+        throw std::invalid_argument(path + " is not an exported weight file");
+    }
+    if (head.version != VERSION) {
+        throw std::invalid_argument(path + " has unsupported weight format version " +
+                                    std::to_string(head.version));
+    }
+    if (head.fileSize != size) {
+        throw std::invalid_argument("Truncated weight file " + path);
+    }
+    if (head.numLayers < 2 || head.numLayers > 64 || head.stateSize == 0 || head.actionSize == 0 ||
+        head.alignment < alignof(float) || (head.alignment & (head.alignment - 1)) != 0) {
+        throw std::invalid_argument("Invalid header in " + path);
+    }
+    if (sizeof(WeightFileHeader) + head.numLayers * sizeof(WeightFileLayer) > size) {
+        throw std::invalid_argument("Truncated weight file " + path);
+    }
+
+    const auto* base = static_cast<const unsigned char*>(data);
+    const auto* records = reinterpret_cast<const WeightFileLayer*>(base + sizeof(WeightFileHeader));
+
+    auto block = [&](uint64_t offset, uint64_t count) {
+        if (offset % head.alignment != 0 || offset > size || count > (size - offset) / sizeof(float)) {
+            throw std::invalid_argument("Float block out of bounds in " + path);
+        }
+        return reinterpret_cast<const float*>(base + offset);
+    };
+
+    uint32_t expectedIn = head.stateSize;
+    for (uint32_t i = 0; i < head.numLayers; ++i) {
+        const WeightFileLayer& record = records[i];
+        bool last = i + 1 == head.numLayers;
+        Activation expectedActivation = last ? NONE : RELU;
+        if (record.in != expectedIn || record.out == 0 || record.outStride < record.out ||
+            record.outStride % DENSE_LANES != 0 || record.outStride > (1u << 16) ||
+            record.activation != expectedActivation) {
+            throw std::invalid_argument("Invalid layer " + std::to_string(i) + " in " + path);
+        }
+        if (last && record.out != head.actionSize + 1) {
+            throw std::invalid_argument("Head does not match the action size in " + path);
+        }
+
+        Layer layer;
+        layer.in = static_cast<int>(record.in);
+        layer.out = static_cast<int>(record.out);
+        layer.outStride = static_cast<int>(record.outStride);
+        layer.activation = expectedActivation;
+        layer.weightsT = block(record.weightsOffset, static_cast<uint64_t>(record.in) * record.outStride);
+        layer.bias = block(record.biasOffset, record.outStride);
+        layerViews.push_back(layer);
+
+        expectedIn = record.outStride;
+    }
+
+    contentHash = 0xCBF29CE484222325ULL;
+    for (std::size_t i = 0; i < size; ++i) {
+        contentHash = (contentHash ^ base[i]) * 0x100000001B3ULL;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef WEIGHT_FILE_H
+#define WEIGHT_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only view of an exported network weight file, memory-mapped so the
+// weights are used in place. Processes that load the same file share one
+// page-cached copy.
+//
+// Layout, all little-endian (written by export_weights.py):
+//
+//     WeightFileHeader                          at offset 0
+//     WeightFileLayer[numLayers]                right after the header
+//     float32 blocks                            each at a multiple of alignment
+//
+// Every layer is stored ready for denseForward(): weights transposed to
+// in x outStride and zero-padded, bias padded to outStride. The input of a
+// layer after the first is the previous layer's padded output. The last
+// layer is the network head: actionSize policy logits followed by the value.
+struct WeightFileHeader {
+    char magic[8];          // "A0WEIGHT"
+    uint32_t version;
+    uint32_t numLayers;
+    uint32_t stateSize;
+    uint32_t actionSize;
+    uint32_t alignment;     // of every float block, in bytes
+    uint32_t reserved;
+    uint64_t fileSize;
+    uint8_t padding[24];
+};
+
+struct WeightFileLayer {
+    uint32_t in;
+    uint32_t out;
+    uint32_t outStride;
+    uint32_t activation;    // WeightFile::Activation
+    uint64_t weightsOffset; // in x outStride floats
+    uint64_t biasOffset;    // outStride floats
+};
+
+static_assert(sizeof(WeightFileHeader) == 64, "weight file header is 64 bytes");
+static_assert(sizeof(WeightFileLayer) == 32, "weight file layer records are 32 bytes");
+
+class WeightFile {
+public:
+    static const uint32_t VERSION = 1;
+
+    enum Activation : uint32_t {
+        NONE = 0,
+        RELU = 1
+    };
+
+    struct Layer {
+        int in;
+        int out;
+        int outStride;
+        Activation activation;
+        const float* weightsT;
+        const float* bias;
+    };
+
+    // Maps and validates path. Throws if the file is missing, truncated or
+    // not a supported version.
+    explicit WeightFile(const std::string& path);
+    ~WeightFile();
+
+    WeightFile(const WeightFile&) = delete;
+    WeightFile& operator=(const WeightFile&) = delete;
+
+    int stateSize() const { return static_cast<int>(header().stateSize); }
+    int actionSize() const { return static_cast<int>(header().actionSize); }
+    const std::vector<Layer>& layers() const { return layerViews; }
+    std::size_t bytes() const { return size; }
+    // FNV-1a hash of the whole file, computed when it is loaded
+    uint64_t checksum() const { return contentHash; }
+
+private:
+    const WeightFileHeader& header() const { return *static_cast<const WeightFileHeader*>(data); }
+    void validate(const std::string& path);
+
+    void* data;
+    std::size_t size;
+    std::vector<Layer> layerViews;
+    uint64_t contentHash;
+};
+
+#endif // WEIGHT_FILE_H
\ No newline at end of file
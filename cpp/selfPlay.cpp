@@ -0,0 +1,184 @@
+#include "algorithms/selfPlay.h"
+#include "algorithms/mcts.h"
+#include "models/mlpModel.h"
+#include "games/ConnectFour/ConnectFour.h"
+#include "games/TicTacToe/TicTacToe.h"
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Generates training data by self-play.
+//
+//   selfPlay [--games N] [--simulations N] [--threads N]
+//            [--game connectfour|tictactoe] [--weights FILE] [--output FILE]
+//            [--temperature T] [--temperature-moves N]
+//            [--dirichlet-alpha A] [--noise FRACTION] [--seed S] [--cache-mb MB]
+//            [--append] [--chunk-records N]
+//            [--concurrent-games N] [--max-batch N] [--max-wait-us US]
+//            [--stats-json FILE]
+//
+// Without --weights the searches use a uniform random model; without
+// --output the games are played but not recorded. --append adds the new
+// samples to an existing replay buffer instead of replacing it.
+// --concurrent-games keeps that many games in flight and evaluates their
+// leaves together in batched model calls. --stats-json writes the run's
+// totals and search statistics as JSON; the per-phase search times in it
+// are only there in a build with MCTS_PROFILE.
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: selfPlay [--games N] [--simulations N] [--threads N]\n"
+              << "                [--game connectfour|tictactoe] [--weights FILE] [--output FILE]\n"
+              << "                [--temperature T] [--temperature-moves N]\n"
+              << "                [--dirichlet-alpha A] [--noise FRACTION] [--seed S] [--cache-mb MB]\n"
+              << "                [--append] [--chunk-records N]\n"
+              << "                [--concurrent-games N] [--max-batch N] [--max-wait-us US]\n"
+              << "                [--stats-json FILE]" << std::endl;
+}
+
+}
+
+int main(int argc, char** argv) {
+    SelfPlayConfig config;
+    std::string gameName = "connectfour";
+    std::string weights;
+    std::string output;
+    std::string statsPath;
+    std::size_t cacheMB = 0;
+    SampleWriter::Mode mode = SampleWriter::Mode::TRUNCATE;
+    int chunkRecords = SampleWriter::DEFAULT_CHUNK_RECORDS;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--append") {
+            mode = SampleWriter::Mode::APPEND;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (flag == "--games") {
+            config.numGames = std::atoi(value);
+        } else if (flag == "--simulations") {
+            config.numSimulations = std::atoi(value);
+        } else if (flag == "--threads") {
+            config.numThreads = std::atoi(value);
+        } else if (flag == "--game") {
+            gameName = value;
+        } else if (flag == "--weights") {
+            weights = value;
+        } else if (flag == "--output") {
+            output = value;
+        } else if (flag == "--temperature") {
+            config.temperature = std::strtof(value, nullptr);
+        } else if (flag == "--temperature-moves") {
+            config.temperatureMoves = std::atoi(value);
+        } else if (flag == "--dirichlet-alpha") {
+            config.dirichletAlpha = std::strtof(value, nullptr);
+        } else if (flag == "--noise") {
+            config.noiseFraction = std::strtof(value, nullptr);
+        } else if (flag == "--seed") {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (flag == "--cache-mb") {
+            cacheMB = std::strtoull(value, nullptr, 10);
+        } else if (flag == "--chunk-records") {
+            chunkRecords = std::atoi(value);
+        } else if (flag == "--concurrent-games") {
+            config.concurrentGames = std::atoi(value);
+        } else if (flag == "--max-batch") {
+            config.maxBatch = std::atoi(value);
+        } else if (flag == "--max-wait-us") {
+            config.maxWaitMicros = std::atoi(value);
+        } else if (flag == "--stats-json") {
+            statsPath = value;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::unique_ptr<Game<int>> game;
+    if (gameName == "connectfour") {
+        game = std::make_unique<ConnectFour>();
+    } else if (gameName == "tictactoe") {
+        game = std::make_unique<TicTacToe>();
+    } else {
+        usage();
+        return 1;
+    }
+    int stateSize = game->stateSpaceSize();
+    int actionSize = game->actionSpaceSize();
+
+    try {
+        std::unique_ptr<Model> model;
+        if (!weights.empty()) {
+            auto mlp = std::make_unique<MLPModel>(weights);
+            if (mlp->stateSize() != stateSize || mlp->actionSize() != actionSize) {
+                std::cerr << weights << " does not fit " << gameName << std::endl;
+                return 1;
+            }
+            model = std::move(mlp);
+        } else {
+            model = std::make_unique<RandomModel>(stateSize, actionSize);
+        }
+
+        std::unique_ptr<EvaluationCache> cache;
+        if (cacheMB > 0) {
+            cache = std::make_unique<EvaluationCache>(cacheMB, actionSize);
+        }
+        std::unique_ptr<SampleWriter> writer;
+        if (!output.empty()) {
+            writer = std::make_unique<SampleWriter>(output, stateSize, actionSize, mode, chunkRecords);
+        }
+
+        SelfPlayStats stats = runSelfPlay(game.get(), model.get(), config, writer.get(), cache.get());
+
+        std::cout << stats.games << " games, " << stats.positions << " positions in "
+                  << stats.seconds << " s" << std::endl;
+        std::cout << "first player: " << stats.wins << " wins, " << stats.draws << " draws, "
+                  << stats.losses << " losses" << std::endl;
+        std::cout << stats.gamesPerSecond() << " games/s, "
+                  << stats.positionsPerSecond() << " positions/s" << std::endl;
+        if (stats.inference.batches > 0) {
+            const InferenceStats& inference = stats.inference;
+            std::cout << inference.batches << " model calls, mean batch " << inference.meanBatchSize()
+                      << " (" << 100.0 * inference.meanBatchFill() << "% full), mean queue latency "
+                      << inference.meanQueueMillis() << " ms" << std::endl;
+        }
+        const SearchStats& search = stats.search;
+        std::cout << search.simulations << " simulations, " << search.nodesAllocated << " nodes, largest tree "
+                  << search.treeBytes / (1024.0 * 1024.0) << " MB" << std::endl;
+        if (SEARCH_PROFILING && search.simulations > 0) {
+            double perSimulation = 1e6 / search.simulations;
+            std::cout << "per simulation: selection " << search.selectionSeconds * perSimulation
+                      << " us, expansion " << search.expansionSeconds * perSimulation
+                      << " us, evaluation " << search.evaluationSeconds * perSimulation
+                      << " us, backpropagation " << search.backpropagationSeconds * perSimulation
+                      << " us; max depth " << search.maxDepth << std::endl;
+        }
+        if (writer) {
+            std::cout << writer->records() << " records in " << output << std::endl;
+        }
+        if (!statsPath.empty()) {
+            std::ofstream json(statsPath);
+            json << "{\"games\": " << stats.games << ", \"positions\": " << stats.positions
+                 << ", \"seconds\": " << stats.seconds << ", \"search\": ";
+            search.writeJson(json);
+            json << "}\n";
+            if (!json) {
+                std::cerr << "Cannot write " << statsPath << std::endl;
+                return 1;
+            }
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
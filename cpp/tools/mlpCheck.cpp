@@ -0,0 +1,122 @@
+#include "../models/dense.h"
+#include "../models/mlpModel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Checks MLPModel against reference outputs computed by PyTorch. The probe
+// file comes from `export_weights.py --probes N` and holds, little-endian:
+//
+//     int32 count, int32 stateSize, int32 actionSize
+//     float32 states[count][stateSize]
+//     float32 policies[count][actionSize]
+//     float32 values[count]
+//
+// Every kernel is run one state at a time and as a single batch.
+//
+//   mlpCheck <weights> <probes> [tolerance]
+
+namespace {
+
+struct Probes {
+    int count;
+    int stateSize;
+    int actionSize;
+    std::vector<float> states;
+    std::vector<float> policies;
+    std::vector<float> values;
+};
+
+bool readProbes(const char* path, Probes& probes) {
+    std::ifstream file(path, std::ios::binary);
+    int32_t header[3];
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || header[0] <= 0 || header[1] <= 0 || header[2] <= 0) {
+        return false;
+    }
+    probes.count = header[0];
+    probes.stateSize = header[1];
+    probes.actionSize = header[2];
+
+    auto read = [&file](std::vector<float>& values, size_t count) {
+        values.resize(count);
+        file.read(reinterpret_cast<char*>(values.data()), count * sizeof(float));
+    };
+    read(probes.states, static_cast<size_t>(probes.count) * probes.stateSize);
+    read(probes.policies, static_cast<size_t>(probes.count) * probes.actionSize);
+    read(probes.values, probes.count);
+    return static_cast<bool>(file);
+}
+
+float maxError(const Probes& probes, const std::vector<float>& policies, const std::vector<float>& values) {
+    float error = 0.0f;
+    for (size_t i = 0; i < policies.size(); ++i) {
+        error = std::max(error, std::fabs(policies[i] - probes.policies[i]));
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        error = std::max(error, std::fabs(values[i] - probes.values[i]));
+    }
+    return error;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: mlpCheck <weights> <probes> [tolerance]" << std::endl;
+        return 2;
+    }
+    float tolerance = argc > 3 ? std::stof(argv[3]) : 1e-5f;
+
+    std::unique_ptr<MLPModel> loaded;
+    try {
+        loaded = std::make_unique<MLPModel>(argv[1]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    MLPModel& model = *loaded;
+
+    Probes probes;
+    if (!readProbes(argv[2], probes)) {
+        std::cerr << "Cannot read probes from " << argv[2] << std::endl;
+        return 2;
+    }
+    if (probes.stateSize != model.stateSize() || probes.actionSize != model.actionSize()) {
+        std::cerr << "Probes do not match the model shape" << std::endl;
+        return 2;
+    }
+
+    bool passed = true;
+    for (bool scalar : {true, false}) {
+        model.setScalarKernels(scalar);
+        const char* kernel = scalar ? "scalar" : denseKernelName();
+
+        std::vector<float> policies(probes.policies.size());
+        std::vector<float> values(probes.count);
+        for (int i = 0; i < probes.count; ++i) {
+            std::vector<float> state(probes.states.begin() + static_cast<size_t>(i) * probes.stateSize,
+                                     probes.states.begin() + static_cast<size_t>(i + 1) * probes.stateSize);
+            auto [policy, value] = model.predict(state);
+            std::copy(policy.begin(), policy.end(), policies.begin() + static_cast<size_t>(i) * probes.actionSize);
+            values[i] = value;
+        }
+        float singleError = maxError(probes, policies, values);
+
+        model.predictBatch(probes.states.data(), probes.count, probes.stateSize,
+                           policies.data(), probes.actionSize, values.data());
+        float batchError = maxError(probes, policies, values);
+
+        std::cout << kernel << ": max abs error " << singleError << " single, "
+                  << batchError << " batched" << std::endl;
+        passed = passed && singleError <= tolerance && batchError <= tolerance;
+    }
+
+    std::cout << (passed ? "OK" : "FAILED") << " (" << probes.count << " probes, tolerance "
+              << tolerance << ")" << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "../games/ConnectFour/ConnectFour.h"
+#include "../games/TicTacToe/TicTacToe.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Counts the move sequences of every length up to a depth through the
+// Game<int> interface and checks them against known answers. A game that
+// ends stops its sequence: the final move is counted at its depth, and
+// nothing below it.
+//
+//   perft [--game connectfour|tictactoe] [--depth D] [--threads N] [--verify-hash]
+//
+// The work is split into subtrees a few plies below the root and shared
+// between the threads, so the nodes/s figure doubles as a throughput
+// benchmark of move(), flipBoard() and getValidActions(). --verify-hash also
+// checks every incremental hash against computeHash(). Exits with 1 on any
+// mismatch.
+
+namespace {
+
+// Move sequences of length 1, 2, ... from the start position
+const long long CONNECT_FOUR_NODES[] = {7, 49, 343, 2401, 16807, 117649, 823536, 5673234, 39394572, 268031646};
+const long long TIC_TAC_TOE_NODES[] = {9, 72, 504, 3024, 15120, 54720, 148176, 200448, 127872};
+
+struct Counts {
+    long long nodes = 0;          // positions reached at the last ply
+    long long hashErrors = 0;
+};
+
+void perft(Game<int>& game, const GameState& state, int depth, bool verifyHash, Counts& counts) {
+    for (int action : game.getValidActions(state)) {
+        auto [next, reward] = game.move(state, action);
+        if (verifyHash && next.hash != game.computeHash(next)) {
+            counts.hashErrors++;
+        }
+        if (depth == 1 || next.isTerminal) {
+            counts.nodes += depth == 1 ? 1 : 0;
+            continue;
+        }
+        GameState flipped = game.flipBoard(next);
+        if (verifyHash && flipped.hash != game.computeHash(flipped)) {
+            counts.hashErrors++;
+        }
+        perft(game, flipped, depth - 1, verifyHash, counts);
+    }
+}
+
+// A subtree still to be counted: position and plies left below it
+struct Task {
+    GameState state;
+    int depth;
+};
+
+// Splits the tree below the root into at least minTasks subtrees, or as
+// deep as the tree allows. Games that end above the counted depth add
+// nothing to it and are dropped.
+std::vector<Task> splitRoot(Game<int>& game, int depth, std::size_t minTasks) {
+    std::vector<Task> tasks = {{game.start(), depth}};
+    while (tasks.size() < minTasks && tasks.front().depth > 1) {
+        std::vector<Task> next;
+        for (const Task& task : tasks) {
+            for (int action : game.getValidActions(task.state)) {
+                GameState child = game.move(task.state, action).first;
+                if (child.isTerminal) {
+                    continue;
+                }
+                next.push_back({game.flipBoard(child), task.depth - 1});
+            }
+        }
+        if (next.empty()) {
+            break;
+        }
+        tasks.swap(next);
+    }
+    return tasks;
+}
+
+Counts countParallel(Game<int>& game, int depth, int numThreads, bool verifyHash) {
+    std::vector<Task> tasks = splitRoot(game, depth, static_cast<std::size_t>(numThreads) * 16);
+
+    std::atomic<std::size_t> next(0);
+    std::vector<Counts> perThread(numThreads);
+    auto worker = [&](int t) {
+        for (;;) {
+            std::size_t index = next.fetch_add(1);
+            if (index >= tasks.size()) {
+                break;
+            }
+            perft(game, tasks[index].state, tasks[index].depth, verifyHash, perThread[t]);
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (int t = 1; t < numThreads; ++t) {
+        helpers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+    Counts total;
+    for (const Counts& counts : perThread) {
+        total.nodes += counts.nodes;
+        total.hashErrors += counts.hashErrors;
+    }
+    return total;
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string gameName = "connectfour";
+    int maxDepth = -1;
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    bool verifyHash = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--verify-hash") {
+            verifyHash = true;
+        } else if (flag == "--game" && i + 1 < argc) {
+            gameName = argv[++i];
+        } else if (flag == "--depth" && i + 1 < argc) {
+            maxDepth = std::atoi(argv[++i]);
+        } else if (flag == "--threads" && i + 1 < argc) {
+            numThreads = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "usage: perft [--game connectfour|tictactoe] [--depth D] [--threads N] [--verify-hash]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<Game<int>> game;
+    const long long* known;
+    int knownDepth;
+    if (gameName == "connectfour") {
+        game = std::make_unique<ConnectFour>();
+        known = CONNECT_FOUR_NODES;
+        knownDepth = sizeof(CONNECT_FOUR_NODES) / sizeof(CONNECT_FOUR_NODES[0]);
+    } else if (gameName == "tictactoe") {
+        game = std::make_unique<TicTacToe>();
+        known = TIC_TAC_TOE_NODES;
+        knownDepth = sizeof(TIC_TAC_TOE_NODES) / sizeof(TIC_TAC_TOE_NODES[0]);
+    } else {
+        std::cerr << "Unknown game " << gameName << std::endl;
+        return 1;
+    }
+    if (maxDepth < 0) {
+        maxDepth = gameName == "connectfour" ? 8 : knownDepth;
+    }
+
+    std::cout << gameName << ", " << numThreads << " threads" << (verifyHash ? ", verifying hashes" : "")
+              << std::endl;
+    std::cout << "depth  nodes  expected  seconds  nodes/s" << std::endl;
+    bool ok = true;
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        auto begin = std::chrono::steady_clock::now();
+        Counts counts = countParallel(*game, depth, numThreads, verifyHash);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        std::cout << depth << "  " << counts.nodes << "  ";
+        if (depth <= knownDepth) {
+            bool match = counts.nodes == known[depth - 1];
+            ok = ok && match;
+            std::cout << known[depth - 1] << (match ? "" : " MISMATCH");
+        } else {
+            std::cout << "?";
+        }
+        std::cout << "  " << seconds << "  " << static_cast<long long>(counts.nodes / std::max(seconds, 1e-9));
+        if (counts.hashErrors > 0) {
+            ok = false;
+            std::cout << "  " << counts.hashErrors << " HASH ERRORS";
+        }
+        std::cout << std::endl;
+    }
+    return ok ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "../algorithms/mcts.h"
+#include "../algorithms/treeFile.h"
+#include "../games/ConnectFour/ConnectFour.h"
+#include "../games/TicTacToe/TicTacToe.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Checks that MCTS2 keeps its tree in bounds across a game and that tree
+// files survive a round trip and are rejected when corrupt.
+//
+//   treeCheck [--dir DIR]
+//
+// One searcher plays both sides of a Connect Four game with a random model,
+// once without and once under a memory limit; the live nodes must stay
+// within what the current search and its reused subtree can account for,
+// and no search may be cut short. Tree files go to DIR (default /tmp).
+// Exits with 1 on any failure.
+
+namespace {
+
+const int SIMULATIONS = 3000;
+const int PLIES = 12;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cout << "FAIL " << what << std::endl;
+        failures++;
+    }
+}
+
+std::string slurp(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Plays PLIES moves with one searcher on both sides
+void selfPlay(ConnectFour& game, Model& model, std::size_t memoryLimit, const std::string& name) {
+    MCTS2 mcts(&game, &model, SIMULATIONS);
+    if (memoryLimit > 0) {
+        mcts.setMemoryLimit(memoryLimit);
+    }
+    // Every search adds at most one expansion per simulation on top of
+    // the subtree it reuses, which the previous search bounded in turn
+    std::size_t maxNodes = 2 * static_cast<std::size_t>(SIMULATIONS) * 7 + 1;
+
+    GameState state = game.start();
+    std::size_t peak = 0;
+    for (int ply = 0; ply < PLIES && !state.isTerminal; ++ply) {
+        SearchStats stats;
+        std::vector<float> probs = mcts.search(state, &stats);
+        peak = std::max(peak, mcts.liveNodes());
+        std::string at = name + " ply " + std::to_string(ply);
+        check(mcts.liveNodes() <= maxNodes, at + ": " + std::to_string(mcts.liveNodes()) + " live nodes");
+        check(stats.memoryStops == 0, at + ": search stopped at the memory limit");
+        check(stats.simulations == SIMULATIONS || stats.decidedStops > 0,
+              at + ": ran " + std::to_string(stats.simulations) + " simulations");
+        if (memoryLimit > 0) {
+            check(mcts.liveBytes() <= memoryLimit, at + ": " + std::to_string(mcts.liveBytes()) + " live bytes");
+        }
+
+        int action = static_cast<int>(std::max_element(probs.begin(), probs.end()) - probs.begin());
+        auto [next, reward] = game.move(state, action);
+        state = next.isTerminal ? next : game.flipBoard(next);
+    }
+    std::cout << name << ": peak " << peak << " live nodes" << std::endl;
+}
+
+// load() must reject the file with std::invalid_argument and leave the
+// searcher usable
+void expectRejected(ConnectFour& game, Model& model, const std::string& path, const std::string& what) {
+    MCTS2 mcts(&game, &model, 10);
+    try {
+        mcts.loadTree(path);
+        check(false, what + ": loaded");
+    } catch (const std::invalid_argument&) {
+    } catch (const std::exception& e) {
+        check(false, what + ": " + e.what());
+    }
+    check(mcts.liveNodes() == 0, what + ": tree left behind");
+    mcts.search(game.start());
+}
+
+void treeFiles(ConnectFour& game, Model& model, const std::string& dir) {
+    std::string path = dir + "/treeCheck.bin";
+    std::string copy = dir + "/treeCheck2.bin";
+    std::string bad = dir + "/treeCheck3.bin";
+
+    MCTS2 mcts(&game, &model, SIMULATIONS);
+    mcts.search(game.start());
+    auto [next, reward] = game.move(game.start(), 3);
+    // Saved from a root moved to by the previous search
+    mcts.search(game.flipBoard(next));
+    mcts.saveTree(path);
+
+    MCTS2 loaded(&game, &model, SIMULATIONS);
+    loaded.loadTree(path);
+    loaded.saveTree(copy);
+    check(slurp(path) == slurp(copy), "round trip: files differ");
+    check(loaded.liveNodes() <= mcts.liveNodes(), "round trip: more nodes than saved");
+
+    std::vector<TreeFileRecord> records;
+    TreeFileHeader header = TreeFile::read(path, records);
+    check(records.size() > 8 && records[0].numChildren > 0, "round trip: root not expanded");
+
+    auto corrupted = [&](const std::string& what, const std::function<void(std::vector<TreeFileRecord>&)>& edit) {
+        std::vector<TreeFileRecord> changed = records;
+        edit(changed);
+        TreeFile::write(bad, header, changed);
+        expectRejected(game, model, bad, what);
+    };
+    corrupted("negative action", [](std::vector<TreeFileRecord>& r) { r[1].action = -5; });
+    corrupted("action out of range", [](std::vector<TreeFileRecord>& r) { r[1].action = 1 << 20; });
+    corrupted("child visits above parent", [](std::vector<TreeFileRecord>& r) { r[1].visits = r[0].visits + 1; });
+    corrupted("negative visits", [](std::vector<TreeFileRecord>& r) { r[0].visits = -1; });
+    corrupted("action twice in a block", [](std::vector<TreeFileRecord>& r) { r[2].action = r[1].action; });
+    corrupted("infinite prior", [](std::vector<TreeFileRecord>& r) { r[1].prior = INFINITY; });
+    corrupted("negative prior", [](std::vector<TreeFileRecord>& r) { r[1].prior = -0.5f; });
+    corrupted("NaN value sum", [](std::vector<TreeFileRecord>& r) { r[1].valueSum = NAN; });
+    corrupted("NaN root value sum", [](std::vector<TreeFileRecord>& r) { r[0].valueSum = NAN; });
+    corrupted("children past the end", [](std::vector<TreeFileRecord>& r) { r.back().flags = 3; r.back().numChildren = 7; });
+
+    std::string data = slurp(path);
+    std::ofstream(bad, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size() - 5));
+    expectRejected(game, model, bad, "truncated");
+
+    // A record count far beyond the file must fail before anything is
+    // allocated for it
+    TreeFileHeader inflated;
+    std::memcpy(&inflated, data.data(), sizeof(inflated));
+    inflated.numRecords = uint64_t(1) << 31;
+    std::string inflatedData = data;
+    std::memcpy(&inflatedData[0], &inflated, sizeof(inflated));
+    std::ofstream(bad, std::ios::binary).write(inflatedData.data(), static_cast<std::streamsize>(inflatedData.size()));
+    expectRejected(game, model, bad, "inflated record count");
+
+    TicTacToe ticTacToe;
+    RandomModel ticTacToeModel(9, 9);
+    MCTS2 other(&ticTacToe, &ticTacToeModel, 10);
+    try {
+        other.loadTree(path);
+        check(false, "other game: loaded");
+    } catch (const std::invalid_argument&) {
+    }
+
+    std::remove(path.c_str());
+    std::remove(copy.c_str());
+    std::remove(bad.c_str());
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string dir = "/tmp";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            std::cerr << "usage: treeCheck [--dir DIR]" << std::endl;
+            return 2;
+        }
+    }
+
+    ConnectFour game;
+    RandomModel model(42, 7);
+    selfPlay(game, model, 0, "unlimited");
+    selfPlay(game, model, 200 << 10, "200 KB");
+    treeFiles(game, model, dir);
+
+    if (failures > 0) {
+        std::cout << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
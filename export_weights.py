@@ -0,0 +1,134 @@
+import argparse
+import struct
+
+import numpy as np
+import torch
+
+from networks import BasicModel
+
+
+# Flat weight file read by the C++ MLPModel; the layout is documented in
+# cpp/models/weightFile.h. Everything is little-endian and every float block
+# starts at a multiple of ALIGNMENT, so the C++ side can mmap the file and use
+# the weights in place. Layers are stored transposed (in x out_stride) and
+# zero-padded to whole SIMD vectors, which is what its kernels consume.
+WEIGHTS_MAGIC = b"A0WEIGHT"
+FORMAT_VERSION = 1
+ALIGNMENT = 64
+LANES = 8
+
+HEADER = struct.Struct("<8sIIIIIIQ24x")
+LAYER = struct.Struct("<IIIIQQ")
+ACTIVATION_NONE = 0
+ACTIVATION_RELU = 1
+
+
+def round_up(n, multiple):
+    return (n + multiple - 1) // multiple * multiple
+
+
+def to_numpy(tensor):
+    return tensor.detach().cpu().to(torch.float32).numpy()
+
+
+def policy_value_layers(state_dict):
+    """(weight, bias) pairs of a BasicPolicyValueNetwork state dict: the ReLU
+    body in order, then the policy and value heads fused into one layer."""
+    hidden = sorted({key.split(".")[1] for key in state_dict if key.startswith("hidden_layers.")}, key=int)
+    names = ["fc1"] + [f"hidden_layers.{index}" for index in hidden]
+    body = [(to_numpy(state_dict[f"{name}.weight"]), to_numpy(state_dict[f"{name}.bias"])) for name in names]
+
+    head_weight = np.concatenate([to_numpy(state_dict["policy_layer.weight"]),
+                                  to_numpy(state_dict["value_layer.weight"])])
+    head_bias = np.concatenate([to_numpy(state_dict["policy_layer.bias"]),
+                                to_numpy(state_dict["value_layer.bias"])])
+    return body + [(head_weight, head_bias)]
+
+
+def export_state_dict(state_dict, path):
+    """Writes the 'policy_value' entry of BasicModel.state_dict() to path."""
+    layers = policy_value_layers(state_dict)
+    state_size = layers[0][0].shape[1]
+    action_size = layers[-1][0].shape[0] - 1
+
+    # transpose and pad every layer; inputs after the first are the previous
+    # layer's padded outputs, so the extra input rows stay zero
+    blocks = []
+    records = []
+    in_size = state_size
+    for index, (weight, bias) in enumerate(layers):
+        out_size, real_in = weight.shape
+        out_stride = round_up(out_size, LANES)
+        weight_t = np.zeros((in_size, out_stride), dtype="<f4")
+        weight_t[:real_in, :out_size] = weight.T
+        padded_bias = np.zeros(out_stride, dtype="<f4")
+        padded_bias[:out_size] = bias
+
+        activation = ACTIVATION_NONE if index == len(layers) - 1 else ACTIVATION_RELU
+        records.append([in_size, out_size, out_stride, activation])
+        blocks += [weight_t, padded_bias]
+        in_size = out_stride
+
+    offset = round_up(HEADER.size + LAYER.size * len(records), ALIGNMENT)
+    offsets = []
+    for block in blocks:
+        offsets.append(offset)
+        offset = round_up(offset + block.nbytes, ALIGNMENT)
+    file_size = offsets[-1] + blocks[-1].nbytes
+
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(WEIGHTS_MAGIC, FORMAT_VERSION, len(records), state_size, action_size,
+                            ALIGNMENT, 0, file_size))
+        for index, record in enumerate(records):
+            f.write(LAYER.pack(*record, offsets[2 * index], offsets[2 * index + 1]))
+        for block_offset, block in zip(offsets, blocks):
+            f.write(b"\0" * (block_offset - f.tell()))
+            f.write(block.tobytes())
+    return len(records)
+
+
+# Random encoded states and the network's outputs for them, for checking
+# the C++ forward pass with cpp/tools/mlpCheck
+def export_probes(network, path, count, seed=0):
+    generator = torch.Generator().manual_seed(seed)
+    states = torch.randint(-1, 2, (count, network.fc1.in_features), generator=generator).float()
+    with torch.no_grad():
+        policies, values = network(states)
+
+    with open(path, "wb") as f:
+        f.write(struct.pack("<iii", count, states.shape[1], policies.shape[1]))
+        for tensor in (states, policies, values.reshape(-1)):
+            f.write(to_numpy(tensor).astype("<f4").tobytes())
+
+
+def load_model(checkpoint, state_size, action_size, hidden_sizes):
+    model = BasicModel(state_size, action_size, hidden_sizes)
+    if checkpoint is not None:
+        state_dict = torch.load(checkpoint, map_location="cpu")["policy_value"]
+        missing, unexpected = model.policy_value.load_state_dict(state_dict, strict=False)
+        if missing or unexpected:
+            # checkpoints saved before hidden_layers was a ModuleList do not
+            # contain the hidden layers, so the network cannot be rebuilt
+            raise ValueError(f"{checkpoint} does not match the network: "
+                             f"missing {missing}, unexpected {unexpected}")
+    model.policy_value.eval()
+    return model
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Export a policy/value network for the C++ MLPModel")
+    parser.add_argument("output", help="weight file to write")
+    parser.add_argument("--checkpoint", help="model.pth saved by AlphaZeroPointZero (random weights if omitted)")
+    parser.add_argument("--state-size", type=int, default=9)
+    parser.add_argument("--action-size", type=int, default=9)
+    parser.add_argument("--hidden-sizes", type=int, nargs="+", default=[128, 128])
+    parser.add_argument("--probes", type=int, default=0, help="also write this many reference outputs to OUTPUT.probes")
+    args = parser.parse_args()
+
+    model = load_model(args.checkpoint, args.state_size, args.action_size, args.hidden_sizes)
+    num_layers = export_state_dict(model.state_dict()["policy_value"], args.output)
+    print(f"Wrote {num_layers} layers to {args.output}")
+
+    if args.probes > 0:
+        export_probes(model.policy_value, args.output + ".probes", args.probes)
+        print(f"Wrote {args.probes} probes to {args.output}.probes")
@@ -10,7 +10,8 @@ class BasicPolicyValueNetwork(nn.Module):
         super().__init__()
         
         self.fc1 = nn.Linear(input_size, hidden_sizes[0])
-        self.hidden_layers = []
+        # a ModuleList registers the layers, so they are trained and saved
+        self.hidden_layers = nn.ModuleList()
         
         for i in range(len(hidden_sizes)-1):
             self.hidden_layers.append(nn.Linear(hidden_sizes[i], hidden_sizes[i + 1]))
@@ -38,7 +39,7 @@ class BasicQNetwork(nn.Module):
         super().__init__()
         
         self.fc1 = nn.Linear(input_size, hidden_sizes[0])
-        self.hidden_layers = []
+        self.hidden_layers = nn.ModuleList()
         
         for i in range(len(hidden_sizes)-1):
             self.hidden_layers.append(nn.Linear(hidden_sizes[i], hidden_sizes[i + 1]))
@@ -0,0 +1,107 @@
+import struct
+
+import numpy as np
+
+
+# Replay buffer written by the C++ SampleWriter; the layout is documented in
+# cpp/data/sampleWriter.h. The file is mapped once and every chunk is exposed
+# as a strided view of the mapping, so opening a buffer reads only the chunk
+# headers no matter how many samples it holds.
+SAMPLES_MAGIC = b"A0SAMPLE"
+CHUNK_MAGIC = b"A0CHUNK\0"
+FORMAT_VERSION = 2
+
+HEADER = struct.Struct("<8sIIIIQ")
+CHUNK = struct.Struct("<8sIIQQ")
+
+
+class ReplayBuffer:
+    def __init__(self, path):
+        self.path = path
+        self.chunks = []  # (first record, record count, byte offset of the records)
+        self.end = HEADER.size
+        self.raw = np.memmap(path, dtype=np.uint8, mode="r")
+
+        magic, version, self.state_size, self.action_size, self.record_bytes, _ = \
+            HEADER.unpack_from(self.raw, 0)
+        if magic != SAMPLES_MAGIC:
+            raise ValueError(f"{path} is not a sample file")
+        if version != FORMAT_VERSION:
+            raise ValueError(f"{path} has unsupported sample format version {version}")
+        self.record_floats = self.state_size + self.action_size + 1
+        if self.record_bytes != 4 * self.record_floats:
+            raise ValueError(f"{path} has inconsistent record sizes")
+        self._scan()
+
+    def refresh(self):
+        """Maps the file again to pick up chunks appended since it was opened."""
+        self.raw = np.memmap(self.path, dtype=np.uint8, mode="r")
+        self._scan()
+
+    def _scan(self):
+        # chunks cut short by a writer that is still running (or crashed) end
+        # the scan; a later refresh() picks them up once they are complete
+        size = len(self.raw)
+        while self.end + CHUNK.size <= size:
+            magic, count, _, first, _ = CHUNK.unpack_from(self.raw, self.end)
+            records = self.end + CHUNK.size
+            if magic != CHUNK_MAGIC or records + count * self.record_bytes > size:
+                break
+            self.chunks.append((first, count, records))
+            self.end = records + count * self.record_bytes
+
+    def __len__(self):
+        if not self.chunks:
+            return 0
+        first, count, _ = self.chunks[-1]
+        return first + count
+
+    def _records(self, chunk):
+        _, count, offset = chunk
+        data = self.raw[offset:offset + count * self.record_bytes]
+        return data.view(np.float32).reshape(count, self.record_floats)
+
+    def split(self, records):
+        """(states, policies, values) views of a records array."""
+        s, a = self.state_size, self.action_size
+        return records[:, :s], records[:, s:s + a], records[:, s + a]
+
+    def window(self, n=None):
+        """Record arrays covering the last n records (all if n is None), one
+        zero-copy view per chunk, oldest first."""
+        total = len(self)
+        start = 0 if n is None else max(total - n, 0)
+        views = []
+        for chunk in reversed(self.chunks):
+            first, count, _ = chunk
+            if first + count <= start:
+                break
+            records = self._records(chunk)
+            views.append(records[max(start - first, 0):])
+        views.reverse()
+        return views
+
+    def arrays(self, n=None):
+        """(states, policies, values) of the last n records, copied into
+        contiguous arrays."""
+        views = self.window(n)
+        if not views:
+            return self.split(np.empty((0, self.record_floats), dtype=np.float32))
+        return self.split(np.concatenate(views))
+
+    def sample(self, batch_size, n=None, rng=None):
+        """(states, policies, values) of batch_size records drawn uniformly
+        from the last n. Only the drawn records are read."""
+        rng = np.random.default_rng() if rng is None else rng
+        views = self.window(n)
+        sizes = np.array([len(view) for view in views])
+        if sizes.sum() == 0:
+            raise ValueError("cannot sample from an empty window")
+        starts = np.concatenate([[0], np.cumsum(sizes)[:-1]])
+        picks = rng.integers(0, sizes.sum(), size=batch_size)
+        owners = np.searchsorted(starts, picks, side="right") - 1
+        batch = np.empty((batch_size, self.record_floats), dtype=np.float32)
+        for owner in np.unique(owners):
+            rows = owners == owner
+            batch[rows] = views[owner][picks[rows] - starts[owner]]
+        return self.split(batch)